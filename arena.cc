@@ -0,0 +1,179 @@
+/* File: arena.cc
+ * --------------
+ * Implementation of the bump-pointer Arena.  See arena.h for comments.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "profile.h"
+#include "utility.h"
+
+#define DEFAULT_BLOCK_SIZE  (64 * 1024)
+#define ALIGNMENT           16
+
+#define RoundUp(n)  (((n) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1))
+
+
+typedef struct ArenaBlock {
+    struct ArenaBlock   *next;      // next block in the chain
+    size_t              size;       // usable bytes after the header
+} ArenaBlock;
+
+// block headers are padded so the data that follows stays aligned
+
+#define BLOCK_HEADER    RoundUp(sizeof(ArenaBlock))
+#define BlockData(b)    ((char *)(b) + BLOCK_HEADER)
+
+struct ArenaImplementation {
+    ArenaBlock  *first;         // chain of every block the arena holds
+    ArenaBlock  *current;       // block allocations are coming from
+    char        *next;          // next free byte in current
+    char        *limit;         // end of current
+    size_t      blockSize;      // size of a normal block
+    long        numAllocs;      // allocations since reset
+    long        bytesUsed;      // bytes requested since reset
+    long        bytesReserved;  // bytes held in blocks
+    int         numBlocks;      // number of blocks held
+};
+
+
+Arena ArenaNew(int blockSize)
+{
+    Arena   arena;
+
+    assert(blockSize >= 0);
+
+    arena = (Arena) malloc(sizeof(struct ArenaImplementation));
+    Assert(arena != NULL);
+
+    // no blocks until the first allocation
+
+    arena->first = arena->current = NULL;
+    arena->next = arena->limit = NULL;
+    arena->blockSize = (blockSize == 0 ? DEFAULT_BLOCK_SIZE : RoundUp(blockSize));
+    arena->numAllocs = 0;
+    arena->bytesUsed = 0;
+    arena->bytesReserved = 0;
+    arena->numBlocks = 0;
+    return arena;
+}
+
+
+void ArenaFree(Arena arena)
+{
+    ArenaBlock  *block, *next;
+
+    assert(arena != NULL);
+
+    for (block = arena->first; block != NULL; block = next) {
+        next = block->next;
+        free(block);
+    }
+    free(arena);
+}
+
+
+static void ArenaUseBlock(Arena arena, ArenaBlock *block)
+{
+    arena->current = block;
+    arena->next = BlockData(block);
+    arena->limit = BlockData(block) + block->size;
+}
+
+
+void ArenaReset(Arena arena)
+{
+    assert(arena != NULL);
+
+    // rewind to the first block; the rest of the chain is reused
+    // as allocations spill over
+
+    if (arena->first != NULL)
+        ArenaUseBlock(arena, arena->first);
+    arena->numAllocs = 0;
+    arena->bytesUsed = 0;
+}
+
+
+static void ArenaNextBlock(Arena arena, size_t size)
+{
+    ArenaBlock  *block;
+    size_t      blockSize;
+
+    // reuse the next block in the chain if it's big enough, which is
+    // the normal case after a reset
+
+    if (arena->current != NULL && arena->current->next != NULL
+        && arena->current->next->size >= size) {
+        ArenaUseBlock(arena, arena->current->next);
+        return;
+    }
+
+    // otherwise get a new block, big enough for oversized requests,
+    // and link it in right after the current one
+
+    blockSize = (size > arena->blockSize ? size : arena->blockSize);
+    block = (ArenaBlock *) malloc(BLOCK_HEADER + blockSize);
+    Assert(block != NULL);
+    block->size = blockSize;
+
+    if (arena->current == NULL) {
+        block->next = arena->first;
+        arena->first = block;
+    } else {
+        block->next = arena->current->next;
+        arena->current->next = block;
+    }
+    arena->numBlocks++;
+    arena->bytesReserved += blockSize;
+    PROFILE_COUNT(ProfileArenaBlocks, 1);
+    ArenaUseBlock(arena, block);
+}
+
+
+void *ArenaAlloc(Arena arena, size_t size)
+{
+    void    *result;
+
+    assert(arena != NULL);
+
+    size = RoundUp(size == 0 ? 1 : size);
+    if ((size_t)(arena->limit - arena->next) < size)
+        ArenaNextBlock(arena, size);
+
+    result = arena->next;
+    arena->next += size;
+    arena->numAllocs++;
+    arena->bytesUsed += size;
+    PROFILE_COUNT(ProfileArenaAllocs, 1);
+    PROFILE_COUNT(ProfileArenaBytes, size);
+    return result;
+}
+
+
+char *ArenaCopyString(Arena arena, const char *s, int length)
+{
+    char    *copy;
+
+    assert(s != NULL);
+    assert(length >= 0);
+
+    copy = (char *) ArenaAlloc(arena, length + 1);
+    memcpy(copy, s, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+
+void ArenaGetStats(Arena arena, ArenaStats *stats)
+{
+    assert(arena != NULL);
+    assert(stats != NULL);
+
+    stats->numAllocs = arena->numAllocs;
+    stats->bytesUsed = arena->bytesUsed;
+    stats->bytesReserved = arena->bytesReserved;
+    stats->numBlocks = arena->numBlocks;
+}
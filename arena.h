@@ -0,0 +1,86 @@
+/*
+ * File: arena.h
+ * -------------
+ * An Arena is a bump-pointer allocator for memory that all dies at the
+ * same time, such as everything the scanner builds while scanning one
+ * file (lexeme text, Declarations, symbol table slots).  Allocating is
+ * a pointer bump in the current block, individual allocations are never
+ * freed, and ArenaReset() releases everything at once in O(1) by
+ * rewinding to the first block.  Reset keeps the blocks around, so a
+ * process that scans file after file reuses the same memory instead of
+ * fragmenting the heap.
+ */
+
+#ifndef _H_arena
+#define _H_arena
+
+#include <stddef.h>
+
+typedef struct ArenaImplementation *Arena;
+
+/*
+ * Type: ArenaStats
+ * ----------------
+ * Usage counters filled in by ArenaGetStats().  The "since reset"
+ * numbers describe the current contents; block numbers describe the
+ * memory the arena holds from the system.
+ */
+typedef struct {
+    long numAllocs;         // allocations since the last reset
+    long bytesUsed;         // bytes requested since the last reset
+    long bytesReserved;     // bytes held in blocks
+    int  numBlocks;         // number of blocks held
+} ArenaStats;
+
+
+/*
+ * Function: ArenaNew()
+ * Usage: arena = ArenaNew(0);
+ * ---------------------------
+ * Makes a new, empty arena that grabs memory blockSize bytes at a time
+ * (0 picks a default).  Requests bigger than a block get a block of
+ * their own.
+ */
+Arena ArenaNew(int blockSize);
+
+/*
+ * Function: ArenaFree()
+ * ---------------------
+ * Returns all of the arena's blocks to the system and frees the arena.
+ */
+void ArenaFree(Arena arena);
+
+/*
+ * Function: ArenaReset()
+ * ----------------------
+ * Releases every allocation made from the arena.  Blocks are kept and
+ * reused by later allocations.  Anything built in the arena is gone;
+ * no destructors are run.
+ */
+void ArenaReset(Arena arena);
+
+/*
+ * Function: ArenaAlloc()
+ * Usage: decl = new(ArenaAlloc(arena, sizeof(Declaration))) Declaration(...);
+ * --------------------------------------------------------------------------
+ * Returns size bytes of uninitialized memory aligned for any type.  The
+ * memory lives until the next ArenaReset() or ArenaFree().
+ */
+void *ArenaAlloc(Arena arena, size_t size);
+
+/*
+ * Function: ArenaCopyString()
+ * Usage: text = ArenaCopyString(arena, yytext, yyleng);
+ * -----------------------------------------------------
+ * Like CopyString(), but the null-terminated copy lives in the arena.
+ */
+char *ArenaCopyString(Arena arena, const char *s, int length);
+
+/*
+ * Function: ArenaGetStats()
+ * -------------------------
+ * Fills in stats with the arena's current usage counters.
+ */
+void ArenaGetStats(Arena arena, ArenaStats *stats);
+
+#endif
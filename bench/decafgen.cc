@@ -0,0 +1,229 @@
+/* File: decafgen.cc
+ * -----------------
+ * Writes a synthetic Decaf program to stdout for benchmarking the
+ * scanner.  The program is a series of classes full of methods full of
+ * statements, like our machine-written sources, with knobs for the
+ * features that matter to the scanner's speed:
+ *
+ *   -b bytes     about how much to write (default 10 MB)
+ *   -u count     number of distinct identifiers (default 1000)
+ *   -l length    average identifier length (default 8)
+ *   -c percent   lines that are comments (default 10)
+ *   -n depth     deepest comment nesting (default 1)
+ *   -s percent   operands that are string literals (default 5)
+ *   -m I:D:H     weights of int, double and hex literals among
+ *                numeric operands (default 70:20:10)
+ *   -r seed      random seed (default 143)
+ *
+ * Usage:   decafgen [options] > corpus.decaf
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static long gBytes = 10 * 1024 * 1024;
+static int gNumIdents = 1000;
+static int gIdentLength = 8;
+static int gCommentPercent = 10;
+static int gMaxNesting = 1;
+static int gStringPercent = 5;
+static int gIntWeight = 70, gDoubleWeight = 20, gHexWeight = 10;
+
+static char **gIdents;
+static long gWritten;
+
+
+static void Emit(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+static void Emit(const char *format, ...)
+{
+    va_list     args;
+
+    va_start(args, format);
+    gWritten += vprintf(format, args);
+    va_end(args);
+}
+
+
+static int Percent()
+{
+    return rand() % 100;
+}
+
+
+/* Identifiers are a letter and then letters, digits and underscores,
+ * with lengths spread evenly around the average. */
+static void MakeIdents()
+{
+    static const char first[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static const char rest[] = "abcdefghijklmnopqrstuvwxyz0123456789_";
+    int     i, j, length;
+
+    gIdents = (char **) malloc(gNumIdents * sizeof(char *));
+    for (i = 0; i < gNumIdents; i++) {
+        length = 1 + rand() % (2 * gIdentLength - 1);
+        gIdents[i] = (char *) malloc(length + 1);
+        gIdents[i][0] = first[rand() % (sizeof(first) - 1)];
+        for (j = 1; j < length; j++)
+            gIdents[i][j] = rest[rand() % (sizeof(rest) - 1)];
+        gIdents[i][length] = '\0';
+    }
+}
+
+
+/* Most programs use a few names a lot, so names are drawn with a
+ * skew towards the front of the list. */
+static const char *Ident()
+{
+    int     a = rand() % gNumIdents, b = rand() % gNumIdents;
+
+    return gIdents[a < b ? a : b];
+}
+
+
+static void Operand()
+{
+    int     weight;
+
+    if (Percent() < gStringPercent) {
+        Emit("\"%s %d\"", Ident(), rand() % 100);
+        return;
+    }
+    if (Percent() < 50) {
+        Emit("%s", Ident());
+        return;
+    }
+    weight = rand() % (gIntWeight + gDoubleWeight + gHexWeight);
+    if (weight < gIntWeight)
+        Emit("%d", rand() % 100000);
+    else if (weight < gIntWeight + gDoubleWeight)
+        Emit("%d.%d%s", rand() % 1000, rand() % 1000, Percent() < 20 ? "E+12" : "");
+    else
+        Emit("0x%X", rand());
+}
+
+
+static void Expression()
+{
+    static const char *ops[] = {"+", "-", "*", "/", "%", "<", "<=", ">", ">=", "==", "!=", "&&", "||"};
+    int     i, numOperands = 1 + rand() % 4;
+
+    Operand();
+    for (i = 1; i < numOperands; i++) {
+        Emit(" %s ", ops[rand() % (sizeof(ops) / sizeof(ops[0]))]);
+        Operand();
+    }
+}
+
+
+static void Comment(const char *indent)
+{
+    int     i, depth = 1 + rand() % gMaxNesting;
+
+    if (depth == 1 && Percent() < 50) {
+        Emit("%s// %s %s\n", indent, Ident(), Ident());
+        return;
+    }
+    Emit("%s", indent);
+    for (i = 0; i < depth; i++)
+        Emit("/* %s\n%s * ", Ident(), indent);
+    Emit("%s %s\n%s", Ident(), Ident(), indent);
+    for (i = 0; i < depth; i++)
+        Emit(" */");
+    Emit("\n");
+}
+
+
+static void Statement(const char *indent)
+{
+    if (Percent() < gCommentPercent) {
+        Comment(indent);
+        return;
+    }
+    switch (rand() % 6) {
+      case 0:
+        Emit("%sint %s;\n", indent, Ident());
+        break;
+      case 1:
+        Emit("%sif (", indent);
+        Expression();
+        Emit(") %s = %s;\n", Ident(), Ident());
+        break;
+      case 2:
+        Emit("%swhile (", indent);
+        Expression();
+        Emit(") { %s = %s + 1; }\n", Ident(), Ident());
+        break;
+      case 3:
+        Emit("%sPrint(", indent);
+        Expression();
+        Emit(");\n");
+        break;
+      default:
+        Emit("%s%s = ", indent, Ident());
+        Expression();
+        Emit(";\n");
+        break;
+    }
+}
+
+
+static void Class()
+{
+    int     i, j, numMethods = 1 + rand() % 8, numStatements;
+
+    Emit("class %s extends %s {\n", Ident(), Ident());
+    for (i = 0; i < numMethods; i++) {
+        Emit("    %s %s(int %s, double %s) {\n", Percent() < 50 ? "void" : "int",
+             Ident(), Ident(), Ident());
+        numStatements = 1 + rand() % 20;
+        for (j = 0; j < numStatements; j++)
+            Statement("        ");
+        Emit("        return %s;\n    }\n", Ident());
+    }
+    Emit("}\n\n");
+}
+
+
+static void Usage()
+{
+    fprintf(stderr, "Usage:   decafgen [-b bytes] [-u idents] [-l length] [-c percent]\n"
+                    "                  [-n depth] [-s percent] [-m I:D:H] [-r seed]\n");
+    exit(2);
+}
+
+
+int main(int argc, char *argv[])
+{
+    int     opt, seed = 143;
+
+    while ((opt = getopt(argc, argv, "b:u:l:c:n:s:m:r:")) != -1) {
+        switch (opt) {
+          case 'b': gBytes = atol(optarg); break;
+          case 'u': gNumIdents = atoi(optarg); break;
+          case 'l': gIdentLength = atoi(optarg); break;
+          case 'c': gCommentPercent = atoi(optarg); break;
+          case 'n': gMaxNesting = atoi(optarg); break;
+          case 's': gStringPercent = atoi(optarg); break;
+          case 'r': seed = atoi(optarg); break;
+          case 'm':
+            if (sscanf(optarg, "%d:%d:%d", &gIntWeight, &gDoubleWeight, &gHexWeight) != 3)
+                Usage();
+            break;
+          default:
+            Usage();
+        }
+    }
+    if (optind != argc || gNumIdents < 1 || gIdentLength < 1 || gMaxNesting < 1
+        || gIntWeight + gDoubleWeight + gHexWeight <= 0)
+        Usage();
+
+    srand(seed);
+    MakeIdents();
+    while (gWritten < gBytes)
+        Class();
+    return 0;
+}
@@ -0,0 +1,269 @@
+/* File: numbers_check.cc
+ * ----------------------
+ * Checks the scanner's numeric converters (numbers.h) against the C
+ * library's: ParseDouble() against strtod(), ParseDecimalInt() against
+ * strtol() and ParseHexInt() against strtoul() cut to 32 bits, as the
+ * scanner converted literals before.  Every value must be bit for bit
+ * the same, and a literal must be out of range exactly when the
+ * library's value is (infinity, past INT_MAX, past 32 bits).
+ *
+ * The doubles checked are boundary cases written out by hand; random
+ * literals of every shape {DOUBLECONSTANT} allows; every double from
+ * random bits, printed to 17 digits; and, for random doubles, the
+ * exact decimal expansion of the point halfway to the next double up,
+ * along with literals just above and just below it.  Those last have
+ * hundreds of digits and round only one way past the 19th, so they
+ * take the path Eisel-Lemire can't decide and hands to strtod().
+ *
+ * Usage:   numbers_check [-n count] [-s seed]
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../numbers.h"
+#include "../scanner.h"
+#include "../utility.h"
+
+#define MAX_LITERAL     1200        // halfway points run to ~770 digits
+#define MAX_FAILURES    20          // reported one by one
+
+// utility.o refers to the scanner's position global
+struct yyltype yylloc;
+
+static long gNumChecked, gNumFailed;
+
+
+static uint64_t Random64()
+{
+    return ((uint64_t) random() << 62) ^ ((uint64_t) random() << 31) ^ random();
+}
+
+
+static void Failed(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+static void Failed(const char *format, ...)
+{
+    va_list     args;
+
+    if (gNumFailed++ >= MAX_FAILURES)
+        return;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+    printf("\n");
+}
+
+
+static void CheckDouble(const char *literal)
+{
+    double      parsed, expected = strtod(literal, NULL);
+    bool        inRange = ParseDouble(literal, strlen(literal), &parsed);
+
+    gNumChecked++;
+    if (memcmp(&parsed, &expected, sizeof(double)) != 0 || inRange == (bool) isinf(expected))
+        Failed("ParseDouble(\"%s\") is %.17g%s, strtod() %.17g",
+               literal, parsed, inRange ? "" : " (out of range)", expected);
+}
+
+
+static void CheckDecimalInt(const char *literal)
+{
+    long        expected = strtol(literal, NULL, 10);
+    int         parsed;
+    bool        inRange = ParseDecimalInt(literal, strlen(literal), &parsed);
+
+    // strtol() saturates at LONG_MAX, itself past INT_MAX
+    gNumChecked++;
+    if (inRange != (expected <= INT_MAX) || parsed != (expected <= INT_MAX ? expected : INT_MAX))
+        Failed("ParseDecimalInt(\"%s\") is %d%s, strtol() %ld",
+               literal, parsed, inRange ? "" : " (out of range)", expected);
+}
+
+
+static void CheckHexInt(const char *literal)
+{
+    unsigned long expected = strtoul(literal, NULL, 16);
+    int         parsed;
+    bool        inRange = ParseHexInt(literal, strlen(literal), &parsed);
+
+    gNumChecked++;
+    if (inRange != (expected <= UINT32_MAX)
+        || parsed != (inRange ? (int)(uint32_t) expected : -1))
+        Failed("ParseHexInt(\"%s\") is %d%s, strtoul() %lu",
+               literal, parsed, inRange ? "" : " (out of range)", expected);
+}
+
+
+/*
+ * Function: ToLiteral()
+ * ---------------------
+ * Rewrites printf()'s %e form of a number in place as a Decaf double
+ * literal: the exponent's 'e' goes to 'E'.  printf() always gives it a
+ * sign and always puts a point in, with the '#' flag.
+ */
+static char *ToLiteral(char *text)
+{
+    char    *e = strchr(text, 'e');
+
+    if (e != NULL)
+        *e = 'E';
+    return text;
+}
+
+
+/*
+ * Function: CheckHalfway()
+ * ------------------------
+ * Checks the point halfway from d to the next double up, which a long
+ * double holds exactly, printed in full, and literals a hair above and
+ * below it: the expansion ends in a 5, which becomes a 4 for below,
+ * and gets a 1 after it for above.
+ */
+static void CheckHalfway(double d)
+{
+    char        literal[MAX_LITERAL];
+    long double halfway = ((long double) d + nextafter(d, INFINITY)) / 2;
+    char        *last, *e;
+    int         length;
+
+    if (isinf(halfway))
+        return;
+    length = snprintf(literal, sizeof(literal) - 2, "%#.*Le", MAX_LITERAL - 100, halfway);
+    if (length >= (int) sizeof(literal) - 2)
+        return;
+    ToLiteral(literal);
+
+    // drop the trailing zeros of the mantissa
+    e = strchr(literal, 'E');
+    for (last = e - 1; *last == '0'; last--)
+        ;
+    memmove(last + 1, e, strlen(e) + 1);
+    CheckDouble(literal);
+
+    if (*last != '5')
+        return;
+    *last = '4';
+    CheckDouble(literal);
+    *last = '5';
+    memmove(last + 2, last + 1, strlen(last + 1) + 1);
+    last[1] = '1';
+    CheckDouble(literal);
+}
+
+
+static const char *gBoundaryDoubles[] = {
+    "0.", "0.0", "0.0E+0", "00012.5000", "3.", "0.12", "2.12", "12.2E+2", "12.E+2",
+    "12.E+002", "1.e-5", "9007199254740992.", "9007199254740993.", "9007199254740994.",
+    "9007199254740995.", "1.E+22", "1.E+23", "1.7976931348623157E+308",
+    "1.7976931348623158E+308", "1.7976931348623159E+308", "1.E+308", "1.E+309", "1.E+400",
+    "1.E+99999999999", "2.2250738585072014E-308", "2.2250738585072011E-308",
+    "4.9406564584124654E-324", "4.9E-324", "2.4703282292062328E-324",
+    "2.4703282292062327E-324", "2.4E-324", "1.E-400", "1.E-99999999999",
+    "123456789012345678901234567890.", "0.000000000000000000000000000000001",
+    "7.2057594037927933E+16", "1.00000000000000011102230246251565404236316680908203125",
+    "1.00000000000000011102230246251565404236316680908203124",
+    "1.00000000000000011102230246251565404236316680908203126",
+    "18446744073709551615.", "18446744073709551616.", "1844674407370955161500000.",
+    "0.00000000000000000000000000000000000000000000000000000000000000000001E+50",
+};
+
+static const char *gBoundaryInts[] = {
+    "0", "7", "000", "2147483646", "2147483647", "2147483648", "4294967295", "4294967296",
+    "00000000002147483647", "00000000002147483648", "9223372036854775807",
+    "9223372036854775808", "99999999999999999999999",
+};
+
+static const char *gBoundaryHexInts[] = {
+    "0x0", "0X12aE", "0xaBcDeF", "0x7fffffff", "0x80000000", "0xFFFFFFFF", "0x100000000",
+    "0x0000000000001", "0x00000000FFFFFFFF", "0x000000100000000", "0xFFFFFFFFFFFFFFFFFF",
+};
+
+
+int main(int argc, char *argv[])
+{
+    char        literal[MAX_LITERAL];
+    double      d;
+    uint64_t    bits;
+    long        count = 200000, i;
+    int         opt, seed = 143, n;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+          case 'n': count = atol(optarg); break;
+          case 's': seed = atoi(optarg); break;
+          default: optind = argc + 1; break;
+        }
+    }
+    if (optind != argc || count < 0) {
+        fprintf(stderr, "Usage:   numbers_check [-n count] [-s seed]\n");
+        return 2;
+    }
+    srandom(seed);
+
+    for (n = 0; n < (int)(sizeof(gBoundaryDoubles) / sizeof(*gBoundaryDoubles)); n++)
+        CheckDouble(gBoundaryDoubles[n]);
+    for (n = 0; n < (int)(sizeof(gBoundaryInts) / sizeof(*gBoundaryInts)); n++)
+        CheckDecimalInt(gBoundaryInts[n]);
+    for (n = 0; n < (int)(sizeof(gBoundaryHexInts) / sizeof(*gBoundaryHexInts)); n++)
+        CheckHexInt(gBoundaryHexInts[n]);
+
+    // the halfway points around the smallest and biggest doubles, and
+    // around the switch from subnormal to normal
+    CheckHalfway(0);
+    CheckHalfway(nextafter(0, 1));
+    CheckHalfway(nextafter(DBL_MIN, 0));
+    CheckHalfway(DBL_MIN);
+    CheckHalfway(nextafter(DBL_MAX, 0));
+    CheckHalfway(1);
+
+    for (i = 0; i < count; i++) {
+        switch (i % 6) {
+          case 0:   // short, as in real code
+            snprintf(literal, sizeof(literal), "%ld.%ld", random() % 100000, random() % 1000000);
+            break;
+          case 1:   // any mantissa, any exponent the table covers and past it
+            snprintf(literal, sizeof(literal), "%llu.E%c%ld",
+                     (unsigned long long)(Random64() >> (random() % 64)),
+                     random() % 2 ? '+' : '-', random() % 360);
+            break;
+          case 2:   // more digits than 64 bits hold
+            snprintf(literal, sizeof(literal), "%llu%llu.%lluE-%ld",
+                     (unsigned long long) Random64(), (unsigned long long) Random64(),
+                     (unsigned long long)(random() % 1000), random() % 40);
+            break;
+          case 3:   // every double, subnormals included, to 17 digits
+          case 4:
+            bits = Random64() & ~(1ULL << 63);
+            memcpy(&d, &bits, sizeof(double));
+            if (isnan(d) || isinf(d))
+                continue;
+            snprintf(literal, sizeof(literal), "%#.16e", d);
+            ToLiteral(literal);
+            break;
+          case 5:
+            bits = Random64() & ~(1ULL << 63);
+            memcpy(&d, &bits, sizeof(double));
+            if (!isnan(d) && !isinf(d))
+                CheckHalfway(d);
+            snprintf(literal, sizeof(literal), "%ld", random());
+            CheckDecimalInt(literal);
+            snprintf(literal, sizeof(literal), "%llu",
+                     (unsigned long long)(Random64() >> (random() % 64)));
+            CheckDecimalInt(literal);
+            snprintf(literal, sizeof(literal), "0x%llX",
+                     (unsigned long long)(Random64() >> (random() % 64)));
+            CheckHexInt(literal);
+            continue;
+        }
+        CheckDouble(ToLiteral(literal));
+    }
+
+    printf("%ld literals checked, %ld differ from the C library's\n", gNumChecked, gNumFailed);
+    return gNumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#!/bin/sh
+#
+# File: release.sh
+# ----------------
+# Builds the optimized pp1s, from the top of the tree: "make pp1-release"
+# runs it as "release.sh release" and "make pp1-pgo" as "release.sh pgo".
+#
+# Either way pp1 is built once with each of flex's table modes:
+#
+#     -Cem    compressed tables, equivalence and meta-equivalence
+#             classes (flex's default: smallest, slowest)
+#     -Cf     full tables
+#     -CF     fast tables
+#
+# with -O2 and link-time optimization across every module, lex.yy.c
+# included, and without flex's -d, so no debug code is compiled in.
+# pgo builds each one instrumented first, trains it on the training
+# corpus, read both from named files and from stdin, and builds it
+# again with the profile.
+#
+# Each build is timed on the measuring corpus, a different mix from
+# the training corpus, and the report gives its throughput and its
+# stripped size.  The fastest is copied to pp1-release or pp1-pgo.
+#
+# The corpora are bundled as recipes rather than files: samples/ plus
+# bench/decafgen output with fixed seeds, written to $BUILD/corpus.
+# RELEASE_BYTES sets the size of each generated file (default 5 MB) and
+# RELEASE_RUNS the number of timed runs to take the best of (default 3).
+# PP1_SRCS, set by the Makefile, lists the sources other than scanner.l.
+
+MODE=$1
+CXX=${CXX:-g++}
+LEX=${LEX:-flex}
+BUILD=build/$MODE
+CORPUS=$BUILD/corpus
+BYTES=${RELEASE_BYTES:-5000000}
+RUNS=${RELEASE_RUNS:-3}
+OPTFLAGS="-O2 -DNDEBUG -flto -Wno-unused -Wno-sign-compare"
+LIBS="-lc -lm -lpthread"
+TABLES="-Cem -Cf -CF"
+
+case "$MODE" in
+    release|pgo) ;;
+    *) echo "Usage: release.sh release|pgo" >&2; exit 2 ;;
+esac
+[ -n "$PP1_SRCS" ] || { echo "release.sh: PP1_SRCS is not set" >&2; exit 2; }
+
+mkdir -p $CORPUS || exit 1
+
+
+# corpus name seed decafgen-options: the training mix leans on
+# what machine-written sources have most of, identifiers and numbers
+generate() {
+    if [ ! -f $CORPUS/$1.decaf ] || [ $CORPUS/$1.decaf -ot bench/decafgen ]; then
+        bench/decafgen -b $BYTES -r $2 $3 > $CORPUS/$1.decaf || exit 1
+    fi
+}
+generate train-default 1 ""
+generate train-idents 2 "-u 50000 -l 12"
+generate train-numbers 3 "-m 40:40:20"
+generate train-comments 4 "-c 30 -n 3 -s 20"
+generate measure 143 ""
+TRAINING="$CORPUS/train-*.decaf samples/*.decaf"
+
+
+# build dir cxxflags: flex's tables are in dir/lex.yy.c already
+build() {
+    mkdir -p $1/obj || exit 1
+    for src in $PP1_SRCS $1/lex.yy.c; do
+        obj=$1/obj/`basename $src | sed 's/\.[a-z]*$//'`.o
+        $CXX $2 -I. -c -o $obj $src || exit 1
+    done
+    $CXX $2 -o $1/pp1 $1/obj/*.o $LIBS || exit 1
+}
+
+
+# prints the best time of $RUNS runs of pp1 over file, in seconds
+best_time() {
+    best=
+    i=0
+    while [ $i -lt $RUNS ]; do
+        start=`date +%s%N`
+        $1 $2 > /dev/null 2>&1
+        end=`date +%s%N`
+        t=`expr $end - $start`
+        if [ -z "$best" ] || [ $t -lt $best ]; then
+            best=$t
+        fi
+        i=`expr $i + 1`
+    done
+    echo $best | awk '{ printf "%.4f", $1 / 1e9 }'
+}
+
+
+bytes=`wc -c < $CORPUS/measure.decaf`
+winner=
+winnerSpeed=0
+printf "%-8s %-5s %10s %10s %12s\n" table opt seconds MB/s "stripped"
+
+for table in $TABLES; do
+    dir=$BUILD/`echo $table | sed 's/^-//'`
+    rm -rf $dir
+    mkdir -p $dir || exit 1
+    $LEX $table -o $dir/lex.yy.c scanner.l || exit 1
+
+    if [ $MODE = pgo ]; then
+        # the profile is named for each object, so both builds
+        # have to use the same object paths
+        build $dir "$OPTFLAGS -fprofile-generate=`pwd`/$dir/profile"
+        for file in $TRAINING; do
+            $dir/pp1 $file > /dev/null 2>&1
+            $dir/pp1 < $file > /dev/null 2>&1
+        done
+        rm -f $dir/obj/*.o
+        build $dir "$OPTFLAGS -fprofile-use=`pwd`/$dir/profile -fprofile-correction"
+    else
+        build $dir "$OPTFLAGS"
+    fi
+
+    strip -o $dir/pp1.stripped $dir/pp1 || exit 1
+    size=`wc -c < $dir/pp1.stripped`
+    seconds=`best_time $dir/pp1 $CORPUS/measure.decaf`
+    speed=`echo $bytes $seconds | awk '{ printf "%.1f", ($2 > 0 ? $1 / $2 / 1e6 : 0) }'`
+    printf "%-8s %-5s %10s %10s %12d\n" $table $MODE $seconds $speed $size
+
+    if [ -z "$winner" ] || [ `echo $speed $winnerSpeed | awk '{ print ($1 > $2) }'` = 1 ]; then
+        winner=$table
+        winnerSpeed=$speed
+        cp $dir/pp1 pp1-$MODE || exit 1
+    fi
+done
+
+echo "fastest: $winner with $MODE flags, $winnerSpeed MB/s, copied to pp1-$MODE"
@@ -0,0 +1,284 @@
+/* File: relex_bench.cc
+ * --------------------
+ * Measures incremental rescanning.  It scans a file with RelexerNew(),
+ * then makes edits of one character at random places: typing a letter,
+ * then deleting it again, so the buffer ends up as it started.  It
+ * reports the time of the first scan, the time per edit and how many
+ * lines each edit scanned on average.  With -t, every edit types the
+ * given text instead of a letter.  -c is short for typing the opening
+ * of a comment, slash then star, which rescans up to the end of the
+ * next comment, or of the file.
+ *
+ * With -v, the Relexer is checked after every edit against a full scan
+ * of the whole edited buffer: every token, error, line and column, and
+ * every identifier's count and first line, must be the same.  That
+ * costs a full scan per edit, so the times are then meaningless.
+ *
+ * Usage:   relex_bench [-e flex|fast] [-n edits] [-c | -t text] [-v] [-s seed] file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include "../relex.h"
+#include "../symtab.h"
+#include "../declaration.h"
+#include "../utility.h"
+
+
+/*
+ * Where a check has got to in the Relexer's tokens: the next one to
+ * compare is token of line, counting from 0 and 1.
+ */
+typedef struct {
+    Relexer     relexer;
+    int         edit;
+    int         line, token;
+} Cursor;
+
+
+static double Now()
+{
+    struct timeval  tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+static char *ReadFile(const char *filename, long *length)
+{
+    FILE    *fp = fopen(filename, "r");
+    char    *text;
+
+    if (fp == NULL)
+        Failure("Can't open %s", filename);
+    fseek(fp, 0, SEEK_END);
+    *length = ftell(fp);
+    rewind(fp);
+    text = (char *) malloc(*length + 1);
+    Assert(text != NULL);
+    if ((long)fread(text, 1, *length, fp) != *length)
+        Failure("Can't read %s", filename);
+    fclose(fp);
+    return text;
+}
+
+
+/*
+ * Function: NextToken()
+ * ---------------------
+ * Returns the Relexer's token the cursor is at and moves past it, or
+ * fails if the Relexer has no more tokens than the full scan.
+ */
+static const LineToken *NextToken(Cursor *cursor)
+{
+    const LineToken *tokens;
+
+    while (cursor->token == RelexerLineTokens(cursor->relexer, cursor->line, &tokens)) {
+        if (cursor->line == RelexerNumLines(cursor->relexer))
+            Failure("After edit %d: the Relexer is missing tokens at the end of the buffer",
+                    cursor->edit);
+        cursor->line++;
+        cursor->token = 0;
+    }
+    return &tokens[cursor->token++];
+}
+
+
+/* Fails unless the Relexer's next token is at pos */
+static void CheckPosition(Cursor *cursor, const LineToken *token, struct yyltype *pos)
+{
+    if (cursor->line != pos->first_line || token->firstColumn != pos->first_column
+        || token->lastColumn != pos->last_column)
+        Failure("After edit %d: the Relexer has line %d cols %d-%d, a full scan line %d cols %d-%d",
+                cursor->edit, cursor->line, token->firstColumn, token->lastColumn,
+                pos->first_line, pos->first_column, pos->last_column);
+}
+
+
+/* The error handler during a full scan */
+static void CheckError(struct yyltype *pos, const char *message, void *clientData)
+{
+    Cursor          *cursor = (Cursor *) clientData;
+    const LineToken *token = NextToken(cursor);
+
+    if (token->type != TOKEN_ERROR || strcmp(token->message, message) != 0)
+        Failure("After edit %d: the Relexer has no error \"%s\" at line %d",
+                cursor->edit, message, cursor->line);
+    CheckPosition(cursor, token, pos);
+}
+
+
+/*
+ * Function: CheckTokens()
+ * -----------------------
+ * Scans text, the whole edited buffer, from scratch, and fails unless
+ * the Relexer has exactly the same tokens and errors, in the same
+ * places, with the same values, and the same identifier counts.
+ */
+static void CheckTokens(Relexer relexer, int edit, const char *text, long length)
+{
+    Cursor          cursor;
+    Scanner         scanner;
+    const LineToken *token;
+    const char      *lineText;
+    struct yyltype  loc;
+    YYSTYPE         value;
+    Declaration     *decl, *full;
+    int             type, lineLength, i;
+
+    cursor.relexer = relexer;
+    cursor.edit = edit;
+    cursor.line = 1;
+    cursor.token = 0;
+
+    scanner = ScannerNewText(text, length, 0, false, NULL);
+    SetErrorHandler(CheckError, &cursor);
+    while ((type = ScannerNextToken(scanner)) != 0) {
+        token = NextToken(&cursor);
+        loc = ScannerLocation(scanner);
+        value = ScannerValue(scanner);
+        lineText = RelexerLineText(relexer, cursor.line, &lineLength);
+        if (token->type != type)
+            Failure("After edit %d: line %d has a token of type %d, a full scan %d",
+                    edit, cursor.line, token->type, type);
+        CheckPosition(&cursor, token, &loc);
+        if (ScannerLength(scanner) != token->lastColumn - token->firstColumn + 1
+            || memcmp(lineText + token->firstColumn - 1, ScannerText(scanner),
+                      ScannerLength(scanner)) != 0
+            || (type == T_IntConstant && token->value.integerConstant != value.integerConstant)
+            || (type == T_DoubleConstant && token->value.doubleConstant != value.doubleConstant)
+            || (type == T_BoolConstant && token->value.boolConstant != value.boolConstant)
+            || (type == T_StringConstant
+                && (token->value.stringConstant.length != value.stringConstant.length
+                    || memcmp(token->value.stringConstant.chars, value.stringConstant.chars,
+                              value.stringConstant.length) != 0)))
+            Failure("After edit %d: the token at line %d col %d differs from a full scan's",
+                    edit, cursor.line, token->firstColumn);
+    }
+    SetErrorHandler(NULL, NULL);
+
+    // nothing may be left over in the Relexer either
+    for (i = cursor.line; i <= RelexerNumLines(relexer); i++)
+        if (RelexerLineTokens(relexer, i, &token) > (i == cursor.line ? cursor.token : 0))
+            Failure("After edit %d: the Relexer has tokens on line %d that a full scan hasn't",
+                    edit, i);
+
+    // identifiers that no longer occur keep their Declarations, with
+    // no occurrences; every other one must match the full scan's
+    for (i = 1; i <= RelexerNumLines(relexer); i++) {
+        lineText = RelexerLineText(relexer, i, &lineLength);
+        for (type = RelexerLineTokens(relexer, i, &token); type > 0; type--, token++) {
+            if (token->type != T_Identifier)
+                continue;
+            decl = token->value.decl;
+            full = ScannerSymbols(scanner)->Lookup(decl->GetName(), decl->GetLength());
+            if (full == NULL || decl->GetOccurrences() != full->GetOccurrences()
+                || decl->GetFirstLine() != full->GetFirstLine())
+                Failure("After edit %d: %s is seen %d time(s) from line %d, by a full scan %d from %d",
+                        edit, decl->GetName(), decl->GetOccurrences(), decl->GetFirstLine(),
+                        full ? full->GetOccurrences() : 0, full ? full->GetFirstLine() : 0);
+        }
+    }
+    ScannerFree(scanner);
+}
+
+
+/* Joins the Relexer's lines back into one buffer, for CheckTokens() */
+static char *JoinLines(Relexer relexer, long *length)
+{
+    const char  *lineText;
+    char        *text;
+    int         i, lineLength;
+
+    *length = 0;
+    for (i = 1; i <= RelexerNumLines(relexer); i++) {
+        RelexerLineText(relexer, i, &lineLength);
+        *length += lineLength;
+    }
+    text = (char *) malloc(*length + 1);
+    Assert(text != NULL);
+    *length = 0;
+    for (i = 1; i <= RelexerNumLines(relexer); i++) {
+        lineText = RelexerLineText(relexer, i, &lineLength);
+        memcpy(text + *length, lineText, lineLength);
+        *length += lineLength;
+    }
+    return text;
+}
+
+
+static void Check(Relexer relexer, int edit)
+{
+    char    *text;
+    long    length;
+
+    text = JoinLines(relexer, &length);
+    CheckTokens(relexer, edit, text, length);
+    free(text);
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char      *engine = "fast", *typed = "x";
+    int             opt, numEdits = 10000, seed = 1, i, line, offset, length;
+    bool            verify = false;
+    long            textLength, numScanned = 0;
+    char            *text;
+    double          start, firstScan, elapsed;
+    Relexer         relexer;
+
+    while ((opt = getopt(argc, argv, "e:n:ct:vs:")) != -1) {
+        switch (opt) {
+          case 'e': engine = optarg; break;
+          case 'n': numEdits = atoi(optarg); break;
+          case 'c': typed = "/*"; break;
+          case 't': typed = optarg; break;
+          case 'v': verify = true; break;
+          case 's': seed = atoi(optarg); break;
+          default: optind = argc + 1; break;
+        }
+    }
+    if (optind != argc - 1 || numEdits < 1 || strchr(typed, '\n') != NULL || *typed == '\0'
+        || (strcmp(engine, "flex") != 0 && strcmp(engine, "fast") != 0)) {
+        fprintf(stderr, "Usage:   relex_bench [-e flex|fast] [-n edits] [-c | -t text] [-v] "
+                        "[-s seed] file\n");
+        return 2;
+    }
+    SetScannerEngine(strcmp(engine, "fast") == 0 ? FastEngine : FlexEngine);
+    srandom(seed);
+    text = ReadFile(argv[optind], &textLength);
+
+    start = Now();
+    relexer = RelexerNew(text, textLength);
+    firstScan = Now() - start;
+    if (verify)
+        Check(relexer, 0);
+
+    start = Now();
+    for (i = 0; i < numEdits; i++) {
+        line = 1 + random() % RelexerNumLines(relexer);
+        RelexerLineText(relexer, line, &length);
+        if (line < RelexerNumLines(relexer))
+            length--;               // type before the newline, not after
+        offset = random() % (length + 1);
+        numScanned += RelexerEdit(relexer, line, offset, line, offset, typed, strlen(typed));
+        if (verify)
+            Check(relexer, 2 * i + 1);
+        numScanned += RelexerEdit(relexer, line, offset, line, offset + strlen(typed), "", 0);
+        if (verify)
+            Check(relexer, 2 * i + 2);
+    }
+    elapsed = Now() - start;
+
+    fprintf(stderr, "%-4s %8d lines %8.3f s first scan %10.2f us/edit %10.2f lines/edit\n",
+            engine, RelexerNumLines(relexer), firstScan,
+            elapsed / (2.0 * numEdits) * 1e6, numScanned / (2.0 * numEdits));
+    RelexerFree(relexer);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,42 @@
+#!/bin/sh
+#
+# File: run.sh
+# ------------
+# The scanner benchmark: generates a set of synthetic corpora with
+# bench/decafgen, each stressing one feature, and runs bench/scan_bench
+# on each in lex mode (scanning alone), in block mode (scanning a block
+# of tokens at a time) and in pp1 mode (scanning and printing, as pp1
+# does), with each scanner engine.  Run it with "make benchmark", from the top
+# of the tree.  For numbers worth comparing, build optimized, e.g.
+#
+#     make clean; make benchmark WITH_DEBUG=-O2
+#
+# BENCH_BYTES sets the size of each corpus (default 20 MB) and
+# BENCH_RUNS the number of runs to take the best of (default 3).
+
+BYTES=${BENCH_BYTES:-20000000}
+RUNS=${BENCH_RUNS:-3}
+CORPUS=bench/corpus
+
+mkdir -p $CORPUS || exit 1
+
+# name, then decafgen options
+while read name options; do
+    if [ ! -f $CORPUS/$name.decaf ] || [ $CORPUS/$name.decaf -ot bench/decafgen ]; then
+        bench/decafgen -b $BYTES $options > $CORPUS/$name.decaf || exit 1
+    fi
+    echo "$name ($options)"
+    for mode in lex block pp1; do
+        for engine in flex fast; do
+            bench/scan_bench -m $mode -e $engine -n $RUNS $CORPUS/$name.decaf || exit 1
+        done
+    done
+done <<PROFILES
+default
+many-idents -u 100000
+long-idents -l 32
+few-idents -u 20
+comments -c 50 -n 4
+strings -s 40
+doubles -m 10:70:20
+PROFILES
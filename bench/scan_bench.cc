@@ -0,0 +1,203 @@
+/* File: scan_bench.cc
+ * -------------------
+ * Measures the scanner on a file.  In lex mode it times scanning alone
+ * (ScannerNew() and ScannerNextToken(), nothing printed); in pp1 mode
+ * it runs pp1's own loop, yylex() and PrintOneToken(), with the output
+ * going to /dev/null.  It reports tokens/sec, MB/sec, the process's
+ * peak RSS and heap allocations per token.  Run each mode in a process
+ * of its own so the peak RSS is that mode's alone.
+ *
+ * Allocations are counted by wrapping malloc, calloc and realloc in
+ * this program, so everything they are called for, including
+ * operator new, is counted.
+ *
+ * block mode is like lex mode, but pulls tokens a block at a time with
+ * ScannerNextBlock(), and touches each one's type and text, as a
+ * consumer of blocks would.
+ *
+ * stream mode is pp1 mode reading stdin instead of a file, as pp1 -m
+ * does: with -k, the scanner keeps its storage within that many KB
+ * (see ScannerSetMemoryBudget()), so the peak RSS shows whether memory
+ * stays bounded however much is piped in.  Only the flex engine
+ * streams, and stdin can only be read once, so there is one run.
+ *
+ * -e fast measures the fast scanner engine instead of the flex one.
+ *
+ * Usage:   scan_bench [-m lex|pp1|block] [-e flex|fast] [-n runs] file
+ *          scan_bench -m stream [-k kbytes] < file
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "../scanner.h"
+#include "../tokenstream.h"
+#include "../utility.h"
+
+#define BLOCK_SIZE  256             // tokens per block in block mode
+
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+static long gNumAllocs;
+
+extern "C" void *malloc(size_t size)
+{
+    gNumAllocs++;
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    gNumAllocs++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    gNumAllocs++;
+    return __libc_realloc(ptr, size);
+}
+
+
+static double Now()
+{
+    struct timeval  tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+static long ScanOnly(const char *filename)
+{
+    Scanner     scanner = ScannerNew(filename, NULL);
+    long        numTokens = 0;
+
+    while (ScannerNextToken(scanner) != 0)
+        numTokens++;
+    ScannerFree(scanner);
+    return numTokens;
+}
+
+
+static long ScanInBlocks(const char *filename)
+{
+    Scanner     scanner = ScannerNew(filename, NULL);
+    TokenBlock  *block = TokenBlockNew(BLOCK_SIZE);
+    long        numTokens = 0, checksum = 0;
+    int         i, n;
+
+    while ((n = ScannerNextBlock(scanner, block)) > 0) {
+        for (i = 0; i < n; i++)
+            checksum += block->types[i] + block->lexemes[i].length;
+        numTokens += n;
+    }
+    TokenBlockFree(block);
+    ScannerFree(scanner);
+    return checksum > 0 ? numTokens : 0;
+}
+
+
+static long ScanAndPrint(const char *filename, long budget)
+{
+    TokenType   token;
+    long        numTokens = 0;
+
+    if (filename != NULL)
+        Inityylex(filename);
+    else
+        Inityylex();
+    if (budget > 0)
+        SetyylexMemoryBudget(budget);
+    while ((token = (TokenType)yylex()) != 0) {
+        PrintOneToken(token, yytext, yylval, yylloc);
+        numTokens++;
+    }
+    Finishyylex();
+    return numTokens;
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char      *mode = "lex", *engine = "flex";
+    int             opt, numRuns = 3, i;
+    long            budget = 0;
+    bool            streaming;
+    long            numTokens = 0, numAllocs;
+    double          start, best = 0, elapsed;
+    struct stat     st;
+    struct rusage   usage;
+
+    while ((opt = getopt(argc, argv, "m:e:n:k:")) != -1) {
+        switch (opt) {
+          case 'm': mode = optarg; break;
+          case 'e': engine = optarg; break;
+          case 'n': numRuns = atoi(optarg); break;
+          case 'k': budget = atol(optarg) * 1024; break;
+          default: optind = argc + 1; break;
+        }
+    }
+    streaming = (strcmp(mode, "stream") == 0);
+    if (optind != argc - (streaming ? 0 : 1) || numRuns < 1 || budget < 0
+        || (budget > 0 && !streaming) || (streaming && strcmp(engine, "flex") != 0)
+        || (strcmp(mode, "lex") != 0 && strcmp(mode, "pp1") != 0 && strcmp(mode, "block") != 0
+            && !streaming)
+        || (strcmp(engine, "flex") != 0 && strcmp(engine, "fast") != 0)) {
+        fprintf(stderr, "Usage:   scan_bench [-m lex|pp1|block] [-e flex|fast] [-n runs] file\n"
+                        "         scan_bench -m stream [-k kbytes] < file\n");
+        return 2;
+    }
+    SetScannerEngine(strcmp(engine, "fast") == 0 ? FastEngine : FlexEngine);
+    if (streaming) {
+        numRuns = 1;
+        st.st_size = 0;
+    } else if (stat(argv[optind], &st) < 0) {
+        Failure("Can't open %s", argv[optind]);
+    }
+
+    // pp1 and stream modes print, as pp1 does, but not to the
+    // terminal; the numbers go to stderr
+    if ((strcmp(mode, "pp1") == 0 || streaming) && freopen("/dev/null", "w", stdout) == NULL)
+        Failure("Can't open /dev/null");
+
+    // report the best of several runs, and the allocations of the last
+    for (i = 0; i < numRuns; i++) {
+        gNumAllocs = 0;
+        start = Now();
+        if (strcmp(mode, "lex") == 0)
+            numTokens = ScanOnly(argv[optind]);
+        else if (strcmp(mode, "block") == 0)
+            numTokens = ScanInBlocks(argv[optind]);
+        else if (streaming)
+            numTokens = ScanAndPrint(NULL, budget);
+        else
+            numTokens = ScanAndPrint(argv[optind], 0);
+        elapsed = Now() - start;
+        if (i == 0 || elapsed < best)
+            best = elapsed;
+    }
+    numAllocs = gNumAllocs;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // how much was piped in isn't known, so there is no MB/s
+    if (streaming) {
+        fprintf(stderr, "%-6s %8ld KB budget %10ld tokens %8.3f s %10.0f tokens/s "
+                "%7ld KB peak RSS\n",
+                mode, budget / 1024, numTokens, best, numTokens / best, usage.ru_maxrss);
+        return 0;
+    }
+
+    fprintf(stderr, "%-5s %-4s %10ld tokens %8.2f MB %8.3f s %10.0f tokens/s %8.1f MB/s "
+            "%7ld KB peak RSS %8.4f allocs/token\n",
+            mode, engine, numTokens, st.st_size / 1e6, best, numTokens / best,
+            st.st_size / 1e6 / best, usage.ru_maxrss,
+            numTokens ? (double)numAllocs / numTokens : 0.0);
+    return 0;
+}
@@ -0,0 +1,228 @@
+/* File: sharedsym_bench.cc
+ * ------------------------
+ * Measures how the multi-file driver's symbol totals scale with the
+ * number of threads.  A run splits a stream of identifier tokens into
+ * files and has 1, 2, 4, ... threads claim the files in turn, as
+ * ScanFiles() does, and count every token in one SharedSymbolTable in
+ * one of two ways:
+ *
+ *   shared    each token is interned straight into the shared table
+ *   private   each file's tokens are interned into a SymbolTable of
+ *             its own, on an arena reset between files, which is then
+ *             merged into the shared table, as the driver's workers do
+ *
+ * Token names are drawn so that a few are very common, as i and x are
+ * in real code, which is where threads sharing a table get in each
+ * other's way.  Each line gives the best of the runs, in seconds, the
+ * tokens counted per second, and the speedup over one thread.
+ *
+ * Usage:   sharedsym_bench [-t maxThreads] [-u numUnique] [-n numTokens]
+ *                          [-f tokensPerFile] [-r runs]
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <atomic>
+#include "../sharedsym.h"
+#include "../symtab.h"
+#include "../declaration.h"
+#include "../arena.h"
+#include "../utility.h"
+
+// utility.o refers to the scanner's position global
+struct yyltype yylloc;
+
+typedef struct {
+    const char      *name;
+    int             length;
+} Token;
+
+typedef struct {
+    Token               *tokens;
+    int                 numTokens, tokensPerFile;
+    bool                shared;         // intern straight into totals
+    std::atomic<int>    *nextFile;
+    SharedSymbolTable   *totals;
+} Worker;
+
+
+static double Now()
+{
+    struct timeval  tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+static void MergeOne(Declaration *decl, void *clientData)
+{
+    ((SharedSymbolTable *) clientData)->Merge(decl);
+}
+
+
+static void *CountFiles(void *clientData)
+{
+    Worker          *worker = (Worker *) clientData;
+    Arena           arena = ArenaNew(0);
+    SymbolTable     *symbols;
+    int             file, start, end, i;
+
+    while ((start = (file = (*worker->nextFile)++) * worker->tokensPerFile)
+           < worker->numTokens) {
+        end = start + worker->tokensPerFile;
+        if (end > worker->numTokens)
+            end = worker->numTokens;
+        if (worker->shared) {
+            for (i = start; i < end; i++)
+                worker->totals->Intern(worker->tokens[i].name, worker->tokens[i].length, file);
+            continue;
+        }
+        symbols = new SymbolTable(0, arena);
+        for (i = start; i < end; i++)
+            symbols->Intern(worker->tokens[i].name, worker->tokens[i].length, file);
+        symbols->Map(MergeOne, worker->totals);
+        delete symbols;
+        ArenaReset(arena);
+    }
+
+    ArenaFree(arena);
+    return NULL;
+}
+
+
+static void AddOccurrences(SharedSymbol *symbol, void *clientData)
+{
+    *(long *) clientData += symbol->occurrences;
+}
+
+
+/*
+ * Function: Run()
+ * ---------------
+ * Counts the tokens on numThreads threads and returns how long that
+ * took, checking that the totals come out the same however they were
+ * counted.
+ */
+static double Run(Token *tokens, int numTokens, int tokensPerFile, int numUnique,
+                  int numThreads, bool shared, int *numNames)
+{
+    std::atomic<int>    nextFile(0);
+    SharedSymbolTable   *totals = new SharedSymbolTable(numUnique);
+    Worker              *workers;
+    pthread_t           *threads;
+    double              start, elapsed;
+    long                numCounted = 0;
+    int                 i;
+
+    workers = (Worker *) malloc(numThreads * sizeof(Worker));
+    threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+    Assert(workers != NULL && threads != NULL);
+
+    start = Now();
+    for (i = 0; i < numThreads; i++) {
+        workers[i].tokens = tokens;
+        workers[i].numTokens = numTokens;
+        workers[i].tokensPerFile = tokensPerFile;
+        workers[i].shared = shared;
+        workers[i].nextFile = &nextFile;
+        workers[i].totals = totals;
+        if (pthread_create(&threads[i], NULL, CountFiles, &workers[i]) != 0)
+            Failure("Can't start counting thread");
+    }
+    for (i = 0; i < numThreads; i++)
+        pthread_join(threads[i], NULL);
+    elapsed = Now() - start;
+
+    totals->Map(AddOccurrences, &numCounted);
+    Assert(numCounted == numTokens);
+    Assert(*numNames < 0 || *numNames == totals->Count());
+    *numNames = totals->Count();
+
+    delete totals;
+    free(threads);
+    free(workers);
+    return elapsed;
+}
+
+
+static double BestOf(int runs, Token *tokens, int numTokens, int tokensPerFile, int numUnique,
+                     int numThreads, bool shared, int *numNames)
+{
+    double      best = 0, elapsed;
+    int         i;
+
+    for (i = 0; i < runs; i++) {
+        elapsed = Run(tokens, numTokens, tokensPerFile, numUnique, numThreads, shared,
+                      numNames);
+        if (i == 0 || elapsed < best)
+            best = elapsed;
+    }
+    return best;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int         maxThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    int         numUnique = 100000, numTokens = 4000000, tokensPerFile = 2000, runs = 3;
+    int         numNames = -1, opt, i;
+    double      r, shared, priv, shared1 = 0, priv1 = 0;
+    char        **names, buf[64];
+    Token       *tokens;
+
+    while ((opt = getopt(argc, argv, "t:u:n:f:r:")) != -1) {
+        switch (opt) {
+          case 't': maxThreads = atoi(optarg); break;
+          case 'u': numUnique = atoi(optarg); break;
+          case 'n': numTokens = atoi(optarg); break;
+          case 'f': tokensPerFile = atoi(optarg); break;
+          case 'r': runs = atoi(optarg); break;
+          default: optind = argc + 1; break;
+        }
+    }
+    if (optind != argc || maxThreads < 1 || numUnique < 1 || numTokens < 1
+        || tokensPerFile < 1 || runs < 1) {
+        fprintf(stderr, "Usage:   sharedsym_bench [-t maxThreads] [-u numUnique] "
+                "[-n numTokens] [-f tokensPerFile] [-r runs]\n");
+        return 2;
+    }
+
+    // the cube of a uniform draw puts most tokens on the first few names
+
+    names = (char **) malloc(numUnique * sizeof(char *));
+    tokens = (Token *) malloc(numTokens * sizeof(Token));
+    Assert(names != NULL && tokens != NULL);
+    srandom(143);
+    for (i = 0; i < numUnique; i++) {
+        sprintf(buf, "var_%d_%lx", i, random());
+        names[i] = CopyString(buf);
+    }
+    for (i = 0; i < numTokens; i++) {
+        r = random() / (RAND_MAX + 1.0);
+        tokens[i].name = names[(int)(r * r * r * numUnique)];
+        tokens[i].length = strlen(tokens[i].name);
+    }
+
+    printf("%d tokens of %d names, in files of %d tokens\n", numTokens, numUnique,
+           tokensPerFile);
+    printf("threads        shared Intern                private + Merge\n");
+    // 1, 2, 4, ... threads, and maxThreads last
+    for (i = 1; i <= maxThreads; i = (i < maxThreads && 2 * i > maxThreads ? maxThreads : 2 * i)) {
+        shared = BestOf(runs, tokens, numTokens, tokensPerFile, numUnique, i, true, &numNames);
+        priv = BestOf(runs, tokens, numTokens, tokensPerFile, numUnique, i, false, &numNames);
+        if (i == 1) {
+            shared1 = shared;
+            priv1 = priv;
+        }
+        printf("%5d   %7.3f s %7.1f M/s (%4.1fx)   %7.3f s %7.1f M/s (%4.1fx)\n", i,
+               shared, numTokens / shared / 1e6, shared1 / shared,
+               priv, numTokens / priv / 1e6, priv1 / priv);
+    }
+    printf("%d names in the totals\n", numNames);
+    return 0;
+}
@@ -0,0 +1,23 @@
+#!/bin/sh
+#
+# File: stream.sh
+# ---------------
+# The streaming benchmark: pipes ever bigger corpora from bench/decafgen
+# into bench/scan_bench -m stream, which scans stdin as pp1 -m does, once
+# with no memory budget and once with STREAM_BUDGET KB (default 1024).
+# The corpora have many distinct identifiers, so without a budget the
+# symbol table, and with it the peak RSS, grows with the input; with
+# one the peak RSS should stay about the same however big the input.
+# Run it with "make benchmark-stream", from the top of the tree.
+#
+# STREAM_SIZES lists the corpus sizes in MB (default 10 40 160).
+
+SIZES=${STREAM_SIZES:-"10 40 160"}
+BUDGET=${STREAM_BUDGET:-1024}
+
+for size in $SIZES; do
+    echo "$size MB"
+    for budget in 0 $BUDGET; do
+        bench/decafgen -b ${size}000000 -u 4000000 | bench/scan_bench -m stream -k $budget || exit 1
+    done
+done
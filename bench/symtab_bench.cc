@@ -0,0 +1,207 @@
+/* File: symtab_bench.cc
+ * ---------------------
+ * Compares the void * HashTable the scanner used to keep its names in,
+ * with the old scanner's 25 buckets as its size hint, against the typed
+ * FlatHashTable and the open addressing SymbolTable on the lookup/enter
+ * pattern the scanner's {IDENTIFIER} rule generates.  Each run enters
+ * numUnique distinct names and then looks up numLookups names drawn
+ * from them.
+ *
+ * Usage:   symtab_bench [numUnique [numLookups]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "../declaration.h"
+#include "../symtab.h"
+#include "../hash.h"
+#include "../flathash.h"
+#include "../utility.h"
+
+#define OLD_NUM_BUCKETS 25
+
+// utility.o refers to the scanner's position global
+struct yyltype yylloc;
+
+
+static double Now()
+{
+    struct timeval  tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+
+static int DeclHash(const void *elem, int numBuckets)
+{
+    Declaration   *d = (Declaration *)elem;
+
+    return StringHash(d->GetName(), numBuckets);
+}
+
+static int DeclCompare(const void *entry1, const void *entry2)
+{
+    Declaration   *d1 = (Declaration *)entry1, *d2 = (Declaration *)entry2;
+
+    return strcmp(d1->GetName(), d2->GetName());
+}
+
+
+/*
+ * The same for the FlatHashTable of Declaration pointers, which is
+ * looked up by name or by Declaration.
+ */
+struct DeclPtrHash {
+    HashCode operator()(const char *name) const { return StringHashCode(name, strlen(name)); }
+    HashCode operator()(Declaration *decl) const { return decl->GetHash(); }
+};
+
+struct DeclPtrEqual {
+    bool operator()(Declaration *decl, const char *name) const
+    {
+        return strcmp(decl->GetName(), name) == 0;
+    }
+    bool operator()(Declaration *decl, Declaration *other) const
+    {
+        return strcmp(decl->GetName(), other->GetName()) == 0;
+    }
+};
+
+
+/*
+ * The old scanner built a throwaway Declaration for every token and
+ * copied the object into the table on a miss.  The copies share their
+ * name with the heap original, so neither is freed here, just as the
+ * scanner never freed its table.
+ */
+static double RunChained(char **names, int numUnique, int *order, int numLookups)
+{
+    HashTable   table;
+    double      start = Now();
+    int         i;
+
+    table = TableNew(sizeof(Declaration), OLD_NUM_BUCKETS, DeclHash, DeclCompare, NULL);
+    for (i = 0; i < numUnique + numLookups; i++) {
+        char        *name = i < numUnique ? names[i] : names[order[i - numUnique]];
+        Declaration *ident = new Declaration(name, 1);
+        Declaration *match = (Declaration *)TableLookup(table, ident);
+
+        if (match != NULL)
+            match->IncrementOccurrences();
+        else
+            TableEnter(table, ident);
+    }
+    Assert(TableCount(table) == numUnique);
+    return Now() - start;
+}
+
+
+static double RunFlat(char **names, int numUnique, int *order, int numLookups)
+{
+    FlatHashTable<Declaration *, DeclPtrHash, DeclPtrEqual> *table =
+        new FlatHashTable<Declaration *, DeclPtrHash, DeclPtrEqual>(0);
+    double      start = Now();
+    int         i;
+
+    for (i = 0; i < numUnique + numLookups; i++) {
+        char        *name = i < numUnique ? names[i] : names[order[i - numUnique]];
+        Declaration **match = table->Lookup(name);
+
+        if (match != NULL)
+            (*match)->IncrementOccurrences();
+        else
+            table->Enter(new Declaration(name, 1));
+    }
+    Assert(table->Count() == numUnique);
+    double elapsed = Now() - start;
+    table->Map([](Declaration *decl) { delete decl; });
+    delete table;
+    return elapsed;
+}
+
+
+static void DeleteDecl(Declaration *decl, void *unused)
+{
+    delete decl;
+}
+
+
+static double RunOpen(char **names, int numUnique, int *order, int numLookups)
+{
+    SymbolTable *table = new SymbolTable(0);
+    double      start = Now();
+    int         i;
+
+    for (i = 0; i < numUnique + numLookups; i++) {
+        char        *name = i < numUnique ? names[i] : names[order[i - numUnique]];
+        Declaration *match = table->Lookup(name);
+
+        if (match != NULL)
+            match->IncrementOccurrences();
+        else
+            table->Enter(new Declaration(name, 1));
+    }
+    Assert(table->Count() == numUnique);
+    double elapsed = Now() - start;
+    table->Map(DeleteDecl, NULL);
+    delete table;
+    return elapsed;
+}
+
+
+static double RunIntern(char **names, int numUnique, int *order, int numLookups)
+{
+    SymbolTable *table = new SymbolTable(0);
+    double      start = Now();
+    int         i;
+
+    for (i = 0; i < numUnique + numLookups; i++) {
+        char        *name = i < numUnique ? names[i] : names[order[i - numUnique]];
+
+        table->Intern(name, strlen(name), 1);
+    }
+    Assert(table->Count() == numUnique);
+    double elapsed = Now() - start;
+    delete table;
+    return elapsed;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int     numUnique = argc > 1 ? atoi(argv[1]) : 20000;
+    int     numLookups = argc > 2 ? atoi(argv[2]) : 10 * numUnique;
+    char    **names;
+    int     *order;
+    char    buf[64];
+    int     i;
+
+    // generated names look like the mangled identifiers in our
+    // machine-written Decaf sources
+
+    names = (char **) malloc(numUnique * sizeof(char *));
+    order = (int *) malloc(numLookups * sizeof(int));
+    Assert(names != NULL && order != NULL);
+    srand(143);
+    for (i = 0; i < numUnique; i++) {
+        sprintf(buf, "var_%d_%x", i, rand());
+        names[i] = CopyString(buf);
+    }
+    for (i = 0; i < numLookups; i++)
+        order[i] = rand() % numUnique;
+
+    double chained = RunChained(names, numUnique, order, numLookups);
+    double flat = RunFlat(names, numUnique, order, numLookups);
+    double open = RunOpen(names, numUnique, order, numLookups);
+    double intern = RunIntern(names, numUnique, order, numLookups);
+
+    printf("%d unique names, %d repeated lookups\n", numUnique, numLookups);
+    printf("  void * HashTable:               %8.3f s\n", chained);
+    printf("  FlatHashTable<Declaration *>:   %8.3f s  (%.1fx)\n", flat, chained / flat);
+    printf("  open-addressing SymbolTable:    %8.3f s  (%.1fx)\n", open, chained / open);
+    printf("  SymbolTable::Intern:            %8.3f s  (%.1fx)\n", intern, chained / intern);
+    return 0;
+}
@@ -9,12 +9,47 @@
 
 #include "declaration.h"
 #include "utility.h"
+#include <string.h>
 
 Declaration::Declaration(char *ident, int lineFound)
 {
     name = CopyString(ident);
+    length = strlen(name);
+    hash = StringHashCode(name, length);
     firstLine = lineFound;
     numOccurrences = 1;
+    id = -1;
+}
+
+Declaration::Declaration(const char *ident, int len, int lineFound)
+{
+    name = CopyString(ident, len);
+    length = len;
+    hash = StringHashCode(name, length);
+    firstLine = lineFound;
+    numOccurrences = 1;
+    id = -1;
+}
+
+Declaration::Declaration(const char *ident, int len, HashCode hashCode,
+                         int lineFound, Arena arena)
+{
+    name = ArenaCopyString(arena, ident, len);
+    length = len;
+    hash = hashCode;
+    firstLine = lineFound;
+    numOccurrences = 1;
+    id = -1;
+}
+
+Declaration::Declaration(Declaration *other, Arena arena)
+{
+    name = ArenaCopyString(arena, other->name, other->length);
+    length = other->length;
+    hash = other->hash;
+    firstLine = other->firstLine;
+    numOccurrences = other->numOccurrences;
+    id = -1;
 }
 
 Declaration::~Declaration()
@@ -27,6 +62,40 @@ void Declaration::IncrementOccurrences()
 	numOccurrences = numOccurrences + 1;
 }
 
+void Declaration::DecrementOccurrences()
+{
+	Assert(numOccurrences > 0);
+	numOccurrences = numOccurrences - 1;
+}
+
+int Declaration::GetOccurrences()
+{
+	return numOccurrences;
+}
+
+void Declaration::SetOccurrences(int count)
+{
+	Assert(count > 0);
+	numOccurrences = count;
+}
+
+int Declaration::GetFirstLine()
+{
+	return firstLine;
+}
+
+void Declaration::SetFirstLine(int line)
+{
+	firstLine = line;
+}
+
+void Declaration::MergeCounts(Declaration *other)
+{
+	numOccurrences += other->numOccurrences;
+	if (other->firstLine < firstLine)
+		firstLine = other->firstLine;
+}
+
 void Declaration::Print()
 {
 	printf("(%s seen %d time(s), first on line %d)\n", name, numOccurrences, firstLine);
@@ -37,4 +106,24 @@ char * Declaration::GetName()
 	return name;
 }
 
+int Declaration::GetLength()
+{
+	return length;
+}
+
+HashCode Declaration::GetHash()
+{
+	return hash;
+}
+
+int Declaration::GetId()
+{
+	return id;
+}
+
+void Declaration::SetId(int newId)
+{
+	id = newId;
+}
+
 
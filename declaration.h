@@ -9,6 +9,9 @@
 #ifndef _H_declaration
 #define _H_declaration
 
+#include "arena.h"
+#include "utility.h"
+
 /*
  * pp1: Declarations at this point are only used to make sure
  * your scanner is working correctly.  You need to implement the interface
@@ -20,6 +23,9 @@ class Declaration
 {
   private:
     char *name;
+    int length;
+    HashCode hash;              // StringHashCode(name, length)
+    int id;                     // unique within its SymbolTable
     int firstLine, numOccurrences;
 
  public:
@@ -28,17 +34,65 @@ class Declaration
      * first occurs to construct a new declaration object */
     Declaration(char *name, int lineFound);
 
+    /* Same as above, but the name is the first length characters
+     * of ident, which need not be null-terminated (e.g. yytext
+     * and yyleng straight from the scanner) */
+    Declaration(const char *ident, int length, int lineFound);
+
+    /* Same as above, but the name is copied into the given arena,
+     * and its hash, already computed by the caller, is passed in.
+     * Use this for Declarations that are themselves allocated in
+     * the arena: they are released with it and never deleted. */
+    Declaration(const char *ident, int length, HashCode hash,
+                int lineFound, Arena arena);
+
+    /* Makes a copy of other, counts and all, with its name in the
+     * given arena.  Used to merge tables built by different
+     * scanners (see SymbolTable::Merge()). */
+    Declaration(Declaration *other, Arena arena);
+
 	~Declaration();
 
     /* call this whenever the same identifier is seen */
     void IncrementOccurrences();
 
+    /* call this whenever an occurrence goes away (e.g. when an
+     * edited line is scanned again, see relex.h) */
+    void DecrementOccurrences();
+
+    /* the count so far; set it outright for a count read back from
+     * somewhere else (see tokencache.h) */
+    int GetOccurrences();
+    void SetOccurrences(int count);
+
+    /* the line the identifier was first seen on.  Set it when edits
+     * move that line or take the occurrence there away. */
+    int GetFirstLine();
+    void SetFirstLine(int line);
+
+    /* call this to fold in the counts of the same identifier seen
+     * somewhere else: occurrences add up, and the first line is the
+     * earlier of the two */
+    void MergeCounts(Declaration *other);
+
     /* called from pp1's main. The method should print the
      * identifier name, occurrence count, and first line seen like this:
      * (myVariable seen 5 time(s), first on line 114) */
     void Print();
     
     char *GetName();
+
+    int GetLength();
+
+    /* the name's StringHashCode, computed once when the
+     * Declaration is made */
+    HashCode GetHash();
+
+    /* a small number naming this identifier, given out in order
+     * (0, 1, 2, ...) by the SymbolTable it is entered in; -1 if it
+     * isn't in a table */
+    int GetId();
+    void SetId(int newId);
     
 };
  
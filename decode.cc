@@ -0,0 +1,94 @@
+/* File: decode.cc
+ * ---------------
+ * Defines the main() routine for pp1decode, which reads a binary token
+ * stream written by pp1 -b on stdin and prints it in pp1's text format.
+ *
+ *    pp1 -b < program.decaf | pp1decode
+ *
+ * prints exactly what pp1 < program.decaf would, error messages and all.
+ */
+
+#include "scanner.h"
+#include "utility.h"
+#include "declaration.h"
+#include "tokenstream.h"
+#include "vector.h"
+#include <stdio.h>
+#include <unistd.h>
+
+// utility.o refers to the scanner's position global
+struct yyltype yylloc;
+
+
+/*
+ * Function: FindSymbol()
+ * ----------------------
+ * Returns the Declaration for an identifier record.  Ids are given out
+ * in order of first appearance, so an id one past the last one seen is
+ * a new identifier that gets a new Declaration.  Anything else is a
+ * repeat whose occurrence count goes up, just as in the scanner.
+ */
+static Declaration *FindSymbol(Vector<Declaration *> &symbols, TokenRecord *record, char *text)
+{
+    Declaration     *decl;
+    int             id = record->value.symbolId;
+
+    if (id == symbols.Length()) {
+        decl = new Declaration(text, record->line);
+        decl->SetId(id);
+        symbols.Append(decl);
+        return decl;
+    }
+    if (id < 0 || id > symbols.Length())
+        Failure("Token stream has a bad symbol id %d", id);
+
+    decl = symbols[id];
+    decl->IncrementOccurrences();
+    return decl;
+}
+
+
+int main(int argc, char *argv[])
+{
+    TokenReader     reader;
+    TokenRecord     record;
+    Vector<Declaration *> symbols;
+    char            *text;
+    YYSTYPE         value;
+    yyltype         loc;
+
+    if (argc != 1) {
+        printf("Usage:   pp1decode < tokens\n");
+        exit(2);
+    }
+
+    reader = TokenReaderNew(STDIN_FILENO);
+
+    while (TokenReaderNext(reader, &record, &text)) {
+        loc.first_line = record.line;
+        loc.first_column = record.firstColumn;
+        loc.last_column = record.lastColumn;
+
+        switch (record.type) {
+          case TOKEN_ERROR:
+            PrintError(record.value.hasPosition ? &loc : NULL, text);
+            continue;
+          case T_IntConstant:
+            value.integerConstant = record.value.integerConstant; break;
+          case T_DoubleConstant:
+            value.doubleConstant = record.value.doubleConstant; break;
+          case T_BoolConstant:
+            value.boolConstant = record.value.boolConstant; break;
+          case T_StringConstant:
+            value.stringConstant.chars = text;
+            value.stringConstant.length = record.textLength;
+            break;
+          case T_Identifier:
+            value.decl = FindSymbol(symbols, &record, text); break;
+        }
+        PrintOneToken((TokenType)record.type, text, value, loc);
+    }
+
+    TokenReaderFree(reader);
+    return 0;
+}
@@ -0,0 +1,76 @@
+/* File: dict.cc
+ * -------------
+ * Defines the main() routine for pp1dict, which makes a symbol
+ * dictionary (see symdict.h) from a corpus of Decaf sources:
+ *
+ *    pp1dict [-n <min-occurrences>] decaf.pp1d file ...
+ *
+ * scans every file and writes the identifiers seen at least
+ * min-occurrences times in all (default 2) to decaf.pp1d, for
+ * pp1 -D decaf.pp1d to share.  Errors in the sources are ignored.
+ */
+
+#include "scanner.h"
+#include "utility.h"
+#include "declaration.h"
+#include "symtab.h"
+#include "symdict.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOTALS_SIZE_HINT 4096
+
+
+static void Usage()
+{
+    printf("Usage:   pp1dict [-n <min-occurrences>] <dictionary> file ...\n");
+    exit(2);
+}
+
+
+static void IgnoreError(struct yyltype *pos, const char *message, void *clientData)
+{
+}
+
+
+static void MergeOne(Declaration *decl, void *clientData)
+{
+    ((SymbolTable *) clientData)->Merge(decl);
+}
+
+
+int main(int argc, char *argv[])
+{
+    SymbolTable     *totals;
+    Scanner         scanner;
+    int             minOccurrences = 2;
+    int             i = 1, file, numNames;
+
+    if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+        minOccurrences = atoi(argv[i + 1]);
+        if (minOccurrences <= 0)
+            Usage();
+        i += 2;
+    }
+    if (argc - i < 2)
+        Usage();
+
+    // scan with the fast engine, which reads the files in place as
+    // fast as anything
+    SetScannerEngine(FastEngine);
+    SetErrorHandler(IgnoreError, NULL);
+    totals = new SymbolTable(TOTALS_SIZE_HINT);
+    for (file = i + 1; file < argc; file++) {
+        scanner = ScannerNew(argv[file], NULL);
+        while (ScannerNextToken(scanner) != 0)
+            ;
+        ScannerSymbols(scanner)->Map(MergeOne, totals);
+        ScannerFree(scanner);
+    }
+
+    numNames = SymbolDictionaryWrite(argv[i], totals, minOccurrences);
+    printf("%d of %d names written to %s\n", numNames, totals->Count(), argv[i]);
+    delete totals;
+    return 0;
+}
@@ -0,0 +1,688 @@
+/* File: driver.cc
+ * ---------------
+ * Implementation of the parallel drivers.  See driver.h for comments.
+ *
+ * In ScanFiles(), each worker thread claims the next unscanned file,
+ * scans it with a Scanner of its own, and folds that file's symbol
+ * table into the totals, one SharedSymbolTable for all the workers.
+ * Nothing is locked, the totals included (see sharedsym.h), so the
+ * workers never wait on each other, and once they have all finished
+ * the totals are complete, with nothing left to merge.  A file's names
+ * still go into a SymbolTable of its own first, since the Scanner
+ * hands out Declarations from one for every token, and so reach the
+ * totals once per file rather than once per token.
+ *
+ * ScanFileInChunks() is a pipeline: workers claim chunks in order and
+ * buffer each chunk's tokens, and the main thread prints the buffered
+ * chunks in order as they finish.  Workers stay at most a window of
+ * chunks ahead of the printing, so memory use doesn't grow with the
+ * size of the file.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <new>
+#include "driver.h"
+#include "scanner.h"
+#include "symtab.h"
+#include "sharedsym.h"
+#include "declaration.h"
+#include "arena.h"
+#include "utility.h"
+
+#define TOTALS_SIZE_HINT    1024
+#define BYTES_PER_NAME      32      // for sizing the shared totals
+#define MAX_TOTALS_HINT     (1 << 22)
+#define DEFAULT_CHUNK_SIZE  (4 * 1024 * 1024)
+#define CHUNKS_PER_THREAD   2       // how far workers may run ahead
+
+
+typedef struct {
+    char                **files;
+    int                 numFiles;
+    TokenCache          cache;          // or NULL
+    std::atomic<int>    *nextFile;      // index of the next unclaimed file
+    const char          *currentFile;   // file this worker is scanning
+    SharedSymbolTable   *totals;        // merged symbols of every file
+} Worker;
+
+
+/*
+ * Function: PrintFileError()
+ * --------------------------
+ * The per-thread error handler: PrintError()'s format with the name of
+ * the file in front, written with a single fprintf so that messages
+ * from different threads don't interleave.
+ */
+static void PrintFileError(struct yyltype *pos, const char *message, void *clientData)
+{
+    Worker  *worker = (Worker *) clientData;
+
+    if (pos)
+        fprintf(stderr, "\n*** Error %s line %d column %d\n*** %s\n\n",
+                worker->currentFile, pos->first_line, pos->first_column, message);
+    else
+        fprintf(stderr, "\n*** Error %s at unidentified position\n*** %s\n\n",
+                worker->currentFile, message);
+}
+
+
+static void MergeOne(Declaration *decl, void *clientData)
+{
+    ((SharedSymbolTable *) clientData)->Merge(decl);
+}
+
+
+/*
+ * Function: ScanCached()
+ * ----------------------
+ * Folds the worker's current file into its totals by way of the
+ * cache: straight from the file's entry if it has one, or else by
+ * scanning it and recording the scan into a new entry.
+ */
+static void ScanCached(Worker *worker, Arena scanArena)
+{
+    CacheEntry  entry = CacheEntryOpen(worker->cache, worker->currentFile, false,
+                                      PrintFileError, worker);
+    Scanner     scanner;
+    int         token;
+
+    if (CacheEntryFound(entry)) {
+        CacheEntryMergeSymbols(entry, MergeOne, worker->totals);
+    } else {
+        SetErrorHandler(CacheEntryAppendError, entry);
+        scanner = ScannerNew(worker->currentFile, scanArena);
+        while ((token = ScannerNextToken(scanner)) != 0)
+            CacheEntryAppend(entry, (TokenType)token, ScannerText(scanner), ScannerLength(scanner),
+                             ScannerValue(scanner), ScannerLocation(scanner));
+        CacheEntryStore(entry);
+        ScannerSymbols(scanner)->Map(MergeOne, worker->totals);
+        ScannerFree(scanner);
+        SetErrorHandler(PrintFileError, worker);
+    }
+    CacheEntryFree(entry);
+}
+
+
+static void *ScanWorker(void *clientData)
+{
+    Worker      *worker = (Worker *) clientData;
+    Arena       scanArena = ArenaNew(0);
+    Scanner     scanner;
+    int         i;
+
+    // every file is scanned on the same arena, which ScannerFree()
+    // resets, so after the first few files no scan allocates
+
+    SetErrorHandler(PrintFileError, worker);
+    while ((i = (*worker->nextFile)++) < worker->numFiles) {
+        worker->currentFile = worker->files[i];
+        if (worker->cache != NULL) {
+            ScanCached(worker, scanArena);
+            continue;
+        }
+        scanner = ScannerNew(worker->currentFile, scanArena);
+        while (ScannerNextToken(scanner) != 0)
+            ;
+        ScannerSymbols(scanner)->Map(MergeOne, worker->totals);
+        ScannerFree(scanner);
+    }
+    SetErrorHandler(NULL, NULL);
+
+    ArenaFree(scanArena);
+    return NULL;
+}
+
+
+/*
+ * Function: EstimateNames()
+ * -------------------------
+ * Returns about how many different names the files hold, for sizing
+ * the totals, whose buckets are fixed once made.  Sources written by
+ * machine, with hardly a name used twice, run to one new name in about
+ * every BYTES_PER_NAME bytes, and anything else to fewer, so this is
+ * an upper bound but for the cap.  A file that can't be read counts
+ * for nothing here; its scan reports the error.
+ */
+static int EstimateNames(char **files, int numFiles)
+{
+    struct stat     st;
+    long long       numBytes = 0;
+    int             i;
+
+    for (i = 0; i < numFiles; i++)
+        if (stat(files[i], &st) == 0)
+            numBytes += st.st_size;
+    return numBytes / BYTES_PER_NAME < MAX_TOTALS_HINT
+           ? (int)(numBytes / BYTES_PER_NAME) : MAX_TOTALS_HINT;
+}
+
+
+static void CollectOne(SharedSymbol *symbol, void *clientData)
+{
+    SharedSymbol    ***next = (SharedSymbol ***) clientData;
+
+    *(*next)++ = symbol;
+}
+
+
+static int CompareNames(const void *a, const void *b)
+{
+    return strcmp((*(SharedSymbol **) a)->name, (*(SharedSymbol **) b)->name);
+}
+
+
+void ScanFiles(char **files, int numFiles, int numThreads, TokenCache cache)
+{
+    std::atomic<int>    nextFile(0);
+    Worker              *workers;
+    pthread_t           *threads;
+    SharedSymbol        **sorted, **next;
+    SharedSymbolTable   *totals;
+    Arena               arena;
+    Declaration         *decl;
+    int                 i, err;
+
+    assert(numFiles >= 0);
+    assert(numThreads > 0);
+
+    // no point in more threads than files
+    if (numThreads > numFiles)
+        numThreads = (numFiles > 0 ? numFiles : 1);
+
+    workers = (Worker *) malloc(numThreads * sizeof(Worker));
+    threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+    Assert(workers != NULL && threads != NULL);
+    totals = new SharedSymbolTable(EstimateNames(files, numFiles));
+
+    for (i = 0; i < numThreads; i++) {
+        workers[i].files = files;
+        workers[i].numFiles = numFiles;
+        workers[i].cache = cache;
+        workers[i].nextFile = &nextFile;
+        workers[i].currentFile = NULL;
+        workers[i].totals = totals;
+        if ((err = pthread_create(&threads[i], NULL, ScanWorker, &workers[i])) != 0)
+            Failure("Can't start scanning thread: %s", strerror(err));
+    }
+    for (i = 0; i < numThreads; i++)
+        pthread_join(threads[i], NULL);
+
+    // print the totals in order of name so the output doesn't depend
+    // on which thread happened to scan which file, each through a
+    // Declaration so it reads as Declaration::Print() has it
+
+    sorted = NULL;
+    if (totals->Count() > 0) {
+        sorted = next = (SharedSymbol **) malloc(totals->Count() * sizeof(SharedSymbol *));
+        Assert(sorted != NULL);
+        totals->Map(CollectOne, &next);
+        qsort(sorted, totals->Count(), sizeof(SharedSymbol *), CompareNames);
+    }
+    arena = ArenaNew(0);
+    for (i = 0; i < totals->Count(); i++) {
+        decl = new(ArenaAlloc(arena, sizeof(Declaration)))
+                    Declaration(sorted[i]->name, sorted[i]->length, sorted[i]->hash,
+                                sorted[i]->firstLine, arena);
+        decl->SetOccurrences(sorted[i]->occurrences);
+        decl->Print();
+    }
+
+    ArenaFree(arena);
+    free(sorted);
+    delete totals;
+    free(threads);
+    free(workers);
+}
+
+
+/*
+ * A chunk's tokens are buffered as ChunkTokens until it is printed.
+ * Lexemes and string constants point into the chunk's mapping and
+ * identifiers at the chunk's own Declarations, so the chunk's Scanner
+ * is kept until then.  Errors are buffered in order with the tokens.
+ */
+typedef struct {
+    int             type;       // TokenType, char, or TOKEN_ERROR
+    struct yyltype  loc;        // lines are counted from the chunk's start
+    YYSTYPE         value;      // for TOKEN_ERROR, integerConstant is
+                                // false if the error has no position
+    const char      *text;      // lexeme, or error message
+    int             length;
+} ChunkToken;
+
+typedef struct {
+    long            offset, length;     // bytes of the file
+    Scanner         scanner;            // what scanned them
+    int             startDepth;         // comment depth it started at
+    Arena           arena;              // for the scanner and messages
+    ChunkToken      *tokens;
+    int             numTokens, maxTokens;
+    bool            done;               // scanned and ready to print
+} Chunk;
+
+typedef struct {
+    const char          *filename;
+    Chunk               *chunks;
+    int                 numChunks;
+    int                 window;         // chunks workers may run ahead
+    int                 nextChunk;      // next chunk to be claimed
+    int                 nextPrinted;    // next chunk to be printed
+    pthread_mutex_t     lock;           // guards the three above and done
+    pthread_cond_t      changed;        // signalled when any of them change
+} ChunkQueue;
+
+
+static ChunkToken *NewChunkToken(Chunk *chunk)
+{
+    if (chunk->numTokens == chunk->maxTokens) {
+        chunk->maxTokens = (chunk->maxTokens ? 2 * chunk->maxTokens : 1024);
+        chunk->tokens = (ChunkToken *) realloc(chunk->tokens, chunk->maxTokens * sizeof(ChunkToken));
+        Assert(chunk->tokens != NULL);
+    }
+    return &chunk->tokens[chunk->numTokens++];
+}
+
+
+/* The error handler while a chunk is being scanned */
+static void BufferChunkError(struct yyltype *pos, const char *message, void *clientData)
+{
+    Chunk       *chunk = (Chunk *) clientData;
+    ChunkToken  *token = NewChunkToken(chunk);
+
+    token->type = TOKEN_ERROR;
+    memset(&token->loc, 0, sizeof(token->loc));
+    if (pos)
+        token->loc = *pos;
+    token->value.integerConstant = (pos != NULL);
+    token->length = strlen(message);
+    token->text = ArenaCopyString(chunk->arena, message, token->length);
+}
+
+
+/*
+ * Function: ScanChunk()
+ * ---------------------
+ * Scans the chunk, starting commentDepth deep in comments, and buffers
+ * its tokens.  Any earlier scan of the chunk is thrown away first.
+ */
+static void ScanChunk(const char *filename, Chunk *chunk, int commentDepth)
+{
+    ChunkToken  *token;
+    int         type;
+
+    if (chunk->scanner != NULL)
+        ScannerFree(chunk->scanner);
+    if (chunk->arena == NULL)
+        chunk->arena = ArenaNew(0);
+    chunk->numTokens = 0;
+    chunk->startDepth = commentDepth;
+    chunk->scanner = ScannerNewChunk(filename, chunk->offset, chunk->length,
+                                     commentDepth, chunk->arena);
+
+    SetErrorHandler(BufferChunkError, chunk);
+    while ((type = ScannerNextToken(chunk->scanner)) != 0) {
+        token = NewChunkToken(chunk);
+        token->type = type;
+        token->loc = ScannerLocation(chunk->scanner);
+        token->value = ScannerValue(chunk->scanner);
+        token->text = ScannerText(chunk->scanner);
+        token->length = ScannerLength(chunk->scanner);
+    }
+    SetErrorHandler(NULL, NULL);
+}
+
+
+static void *ChunkWorker(void *clientData)
+{
+    ChunkQueue  *queue = (ChunkQueue *) clientData;
+    int         i;
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        while (queue->nextChunk < queue->numChunks
+               && queue->nextChunk >= queue->nextPrinted + queue->window)
+            pthread_cond_wait(&queue->changed, &queue->lock);
+        i = queue->nextChunk++;
+        pthread_mutex_unlock(&queue->lock);
+        if (i >= queue->numChunks)
+            return NULL;
+
+        // guess that the chunk doesn't start inside a comment
+        ScanChunk(queue->filename, &queue->chunks[i], 0);
+
+        pthread_mutex_lock(&queue->lock);
+        queue->chunks[i].done = true;
+        pthread_cond_broadcast(&queue->changed);
+        pthread_mutex_unlock(&queue->lock);
+    }
+}
+
+
+/*
+ * Function: SplitFile()
+ * ---------------------
+ * Divides the file into chunks of about chunkSize bytes, each ending
+ * just after a newline (or at the end of the file).  Returns the
+ * number of chunks, which is at least 1.
+ */
+static int SplitFile(const char *filename, long chunkSize, Chunk **chunks)
+{
+    struct stat st;
+    int         fd, n, maxChunks;
+    char        *text;
+    const char  *newline;
+    long        start, end;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0)
+        Failure("Can't open %s: %s", filename, strerror(errno));
+    text = NULL;
+    if (st.st_size > 0) {
+        text = (char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (text == MAP_FAILED)
+            Failure("Can't map %s: %s", filename, strerror(errno));
+    }
+    close(fd);
+
+    maxChunks = st.st_size / chunkSize + 1;
+    *chunks = (Chunk *) malloc(maxChunks * sizeof(Chunk));
+    Assert(*chunks != NULL);
+    memset(*chunks, 0, maxChunks * sizeof(Chunk));
+
+    // only the pages around each split point are read here
+    for (n = 0, start = 0; n == 0 || start < st.st_size; n++, start = end) {
+        end = start + chunkSize;
+        if (end >= st.st_size)
+            end = st.st_size;
+        else if ((newline = (const char *) memchr(text + end, '\n', st.st_size - end)) != NULL)
+            end = newline - text + 1;
+        else
+            end = st.st_size;
+        Assert(n < maxChunks);
+        (*chunks)[n].offset = start;
+        (*chunks)[n].length = end - start;
+    }
+
+    if (text != NULL)
+        munmap(text, st.st_size);
+    return n;
+}
+
+
+/*
+ * Function: PrintChunk()
+ * ----------------------
+ * Prints (or writes) a scanned chunk's tokens in order.  firstLine is
+ * the line the chunk starts on.  Each of the chunk's identifiers is
+ * entered in symbols, in order, the first time it turns up in the
+ * chunk; after that, the chunk's Declaration id finds it directly.
+ */
+static void PrintChunk(Chunk *chunk, int firstLine, SymbolTable *symbols, TokenWriter writer)
+{
+    Declaration     **found;
+    ChunkToken      *token;
+    YYSTYPE         value;
+    struct yyltype  loc;
+    char            *text = NULL;
+    int             textCapacity = 0;
+    int             i, id, numIds;
+
+    // a chunk with no identifiers needs no table of them
+
+    found = NULL;
+    if ((numIds = ScannerSymbols(chunk->scanner)->Count()) > 0) {
+        found = (Declaration **) calloc(numIds, sizeof(Declaration *));
+        Assert(found != NULL);
+    }
+
+    for (i = 0; i < chunk->numTokens; i++) {
+        token = &chunk->tokens[i];
+        loc = token->loc;
+        loc.first_line += firstLine - 1;
+        value = token->value;
+
+        if (token->type == TOKEN_ERROR) {
+            if (writer)
+                TokenWriterAppendError(value.integerConstant ? &loc : NULL, token->text, writer);
+            else
+                PrintError(value.integerConstant ? &loc : NULL, token->text);
+            continue;
+        }
+
+        if (token->type == T_Identifier) {
+            id = value.decl->GetId();
+            if (found[id] == NULL)
+                found[id] = symbols->Intern(token->text, token->length, loc.first_line);
+            else
+                found[id]->IncrementOccurrences();
+            value.decl = found[id];
+        }
+
+        if (writer) {
+            TokenWriterAppend(writer, (TokenType)token->type, token->text, token->length, value, loc);
+            continue;
+        }
+
+        // the lexeme isn't null-terminated in the mapping
+        if (token->length + 1 > textCapacity) {
+            textCapacity = 2 * (token->length + 1);
+            text = (char *) realloc(text, textCapacity);
+            Assert(text != NULL);
+        }
+        memcpy(text, token->text, token->length);
+        text[token->length] = '\0';
+        PrintOneToken((TokenType)token->type, text, value, loc);
+    }
+
+    free(text);
+    free(found);
+}
+
+
+void ScanFileInChunks(const char *filename, int numThreads, long chunkSize,
+                      TokenWriter writer)
+{
+    ChunkQueue      queue;
+    Chunk           *chunk;
+    pthread_t       *threads;
+    SymbolTable     *symbols;
+    int             i, err, firstLine, commentDepth;
+
+    assert(numThreads > 0);
+    assert(chunkSize >= 0);
+    if (chunkSize == 0)
+        chunkSize = DEFAULT_CHUNK_SIZE;
+
+    queue.filename = filename;
+    queue.numChunks = SplitFile(filename, chunkSize, &queue.chunks);
+    queue.window = CHUNKS_PER_THREAD * numThreads;
+    queue.nextChunk = 0;
+    queue.nextPrinted = 0;
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_cond_init(&queue.changed, NULL);
+
+    threads = (pthread_t *) malloc(numThreads * sizeof(pthread_t));
+    Assert(threads != NULL);
+    for (i = 0; i < numThreads; i++)
+        if ((err = pthread_create(&threads[i], NULL, ChunkWorker, &queue)) != 0)
+            Failure("Can't start scanning thread: %s", strerror(err));
+
+    symbols = new SymbolTable(TOTALS_SIZE_HINT);
+    firstLine = 1;
+    commentDepth = 0;
+
+    for (i = 0; i < queue.numChunks; i++) {
+        chunk = &queue.chunks[i];
+        pthread_mutex_lock(&queue.lock);
+        while (!chunk->done)
+            pthread_cond_wait(&queue.changed, &queue.lock);
+        pthread_mutex_unlock(&queue.lock);
+
+        // the previous chunk ended inside a comment, so the guess
+        // this one was scanned with is wrong
+        if (chunk->startDepth != commentDepth)
+            ScanChunk(filename, chunk, commentDepth);
+
+        PrintChunk(chunk, firstLine, symbols, writer);
+        firstLine += ScannerLocation(chunk->scanner).first_line - 1;
+        commentDepth = ScannerCommentDepth(chunk->scanner);
+
+        ScannerFree(chunk->scanner);
+        ArenaFree(chunk->arena);
+        free(chunk->tokens);
+
+        pthread_mutex_lock(&queue.lock);
+        queue.nextPrinted++;
+        pthread_cond_broadcast(&queue.changed);
+        pthread_mutex_unlock(&queue.lock);
+    }
+
+    for (i = 0; i < numThreads; i++)
+        pthread_join(threads[i], NULL);
+
+    delete symbols;
+    free(threads);
+    free(queue.chunks);
+    pthread_mutex_destroy(&queue.lock);
+    pthread_cond_destroy(&queue.changed);
+}
+
+
+/*
+ * CompareEngines() runs one scanner of each engine a token at a time,
+ * with each scanner's errors logged as text so that the errors
+ * reported on the way to a token can be compared too.
+ */
+
+typedef struct {
+    char        *text;          // messages since the last token
+    int         length, capacity;
+} ErrorLog;
+
+
+static void LogError(struct yyltype *pos, const char *message, void *clientData)
+{
+    ErrorLog    *log = (ErrorLog *) clientData;
+    char        entry[64];
+    int         length, entryLength;
+
+    if (pos)
+        entryLength = snprintf(entry, sizeof(entry), "line %d cols %d-%d: ",
+                               pos->first_line, pos->first_column, pos->last_column);
+    else
+        entryLength = snprintf(entry, sizeof(entry), "no position: ");
+    length = entryLength + strlen(message) + 1;
+    if (log->length + length + 1 > log->capacity) {
+        log->capacity = 2 * (log->length + length + 1);
+        log->text = (char *) realloc(log->text, log->capacity);
+        Assert(log->text != NULL);
+    }
+    sprintf(log->text + log->length, "%s%s\n", entry, message);
+    log->length += length;
+}
+
+
+static int NextToken(Scanner scanner, ErrorLog *log)
+{
+    int     type;
+
+    log->length = 0;
+    if (log->text != NULL)
+        log->text[0] = '\0';
+    SetErrorHandler(LogError, log);
+    type = ScannerNextToken(scanner);
+    SetErrorHandler(NULL, NULL);
+    return type;
+}
+
+
+static bool SameValue(int type, YYSTYPE a, YYSTYPE b)
+{
+    switch (type) {
+      case T_IntConstant:
+        return a.integerConstant == b.integerConstant;
+      case T_DoubleConstant:
+        return a.doubleConstant == b.doubleConstant;
+      case T_BoolConstant:
+        return a.boolConstant == b.boolConstant;
+      case T_StringConstant:
+        return a.stringConstant.length == b.stringConstant.length
+            && memcmp(a.stringConstant.chars, b.stringConstant.chars, a.stringConstant.length) == 0;
+      case T_Identifier:
+        return strcmp(a.decl->GetName(), b.decl->GetName()) == 0
+            && a.decl->GetId() == b.decl->GetId();
+    }
+    return true;
+}
+
+
+bool CompareEngines(const char *filename)
+{
+    Scanner         scanners[2];
+    ErrorLog        logs[2];
+    const char      *names[2] = {"flex", "fast"};
+    int             types[2];
+    struct yyltype  locs[2];
+    int             i, numTokens, numErrors;
+    bool            same = true;
+
+    SetScannerEngine(FlexEngine);
+    scanners[0] = ScannerNew(filename, NULL);
+    SetScannerEngine(FastEngine);
+    scanners[1] = ScannerNew(filename, NULL);
+    memset(logs, 0, sizeof(logs));
+
+    for (numTokens = numErrors = 0; same; numTokens++) {
+        for (i = 0; i < 2; i++) {
+            types[i] = NextToken(scanners[i], &logs[i]);
+            locs[i] = ScannerLocation(scanners[i]);
+        }
+
+        same = (logs[0].length == logs[1].length
+                && (logs[0].length == 0 || memcmp(logs[0].text, logs[1].text, logs[0].length) == 0));
+        if (!same) {
+            fprintf(stderr, "Engines report different errors before token %d:\n", numTokens + 1);
+            for (i = 0; i < 2; i++)
+                fprintf(stderr, "%s:\n%.*s", names[i], logs[i].length, logs[i].text);
+            break;
+        }
+        for (i = 0; i < logs[0].length; i++)
+            numErrors += (logs[0].text[i] == '\n');
+        if (types[0] == 0 && types[1] == 0)
+            break;
+
+        same = (types[0] == types[1]
+                && locs[0].first_line == locs[1].first_line
+                && locs[0].first_column == locs[1].first_column
+                && locs[0].last_column == locs[1].last_column
+                && ScannerLength(scanners[0]) == ScannerLength(scanners[1])
+                && memcmp(ScannerText(scanners[0]), ScannerText(scanners[1]),
+                          ScannerLength(scanners[0])) == 0
+                && SameValue(types[0], ScannerValue(scanners[0]), ScannerValue(scanners[1])));
+        if (!same) {
+            fprintf(stderr, "Engines differ at token %d:\n", numTokens + 1);
+            for (i = 0; i < 2; i++)
+                fprintf(stderr, "%s: type %d \"%.*s\" line %d cols %d-%d\n", names[i],
+                        types[i], ScannerLength(scanners[i]), ScannerText(scanners[i]),
+                        locs[i].first_line, locs[i].first_column, locs[i].last_column);
+        }
+    }
+
+    if (same)
+        printf("flex and fast engines agree on %d tokens and %d errors\n", numTokens, numErrors);
+    for (i = 0; i < 2; i++) {
+        ScannerFree(scanners[i]);
+        free(logs[i].text);
+    }
+    return same;
+}
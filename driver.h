@@ -0,0 +1,66 @@
+/*
+ * File: driver.h
+ * --------------
+ * The parallel drivers.  ScanFiles() scans many input files at once on
+ * a pool of threads, each with its own reentrant Scanner, and reports
+ * the identifier statistics of all of them together.  ScanFileInChunks()
+ * splits one big file into chunks, scans those at once, and prints
+ * exactly what scanning it in one go would.  CompareEngines() checks
+ * the fast scanner engine against the flex one.
+ */
+
+#ifndef _H_driver
+#define _H_driver
+
+#include "tokenstream.h"
+#include "tokencache.h"
+
+/*
+ * Function: ScanFiles()
+ * Usage: ScanFiles(argv + 1, argc - 1, 8, NULL);
+ * ----------------------------------------------
+ * Scans each of the named files on numThreads threads and then prints
+ * every identifier seen in any of them, sorted by name, with the total
+ * number of times it was seen and the earliest line it was first seen
+ * on, in Declaration::Print()'s format.  Errors go to stderr as they
+ * are found, each preceded by the name of its file.  Given a cache,
+ * files found in it aren't scanned at all, and the rest are stored
+ * in it once they have been.
+ */
+void ScanFiles(char **files, int numFiles, int numThreads, TokenCache cache);
+
+/*
+ * Function: ScanFileInChunks()
+ * Usage: ScanFileInChunks("huge.decaf", 8, 0, NULL);
+ * --------------------------------------------------
+ * Scans the named file on numThreads threads and prints its tokens
+ * and errors just as pp1 does, or adds them to writer if it isn't
+ * NULL.  The file is split at line boundaries into chunks of about
+ * chunkSize bytes (0 picks a default), which are scanned ahead in
+ * parallel while the main thread prints finished chunks in order.
+ *
+ * A chunk's tokens depend on whether it starts inside a comment, which
+ * isn't known until the chunk before it has been scanned.  Each chunk
+ * is scanned guessing that it doesn't; the rare chunk whose guess turns
+ * out wrong is scanned again, with the right start, before it is
+ * printed.  Line numbers are counted per chunk and adjusted as chunks
+ * are printed, and identifiers are entered in one symbol table in
+ * order, so every position, count and symbol id comes out the same as
+ * from a sequential scan.
+ */
+void ScanFileInChunks(const char *filename, int numThreads, long chunkSize,
+                      TokenWriter writer);
+
+/*
+ * Function: CompareEngines()
+ * Usage: if (!CompareEngines("program.decaf")) exit(1);
+ * -----------------------------------------------------
+ * Scans the named file with the flex engine and the fast engine side
+ * by side and checks that they return the same tokens, with the same
+ * text, positions and values, and report the same errors in the same
+ * places.  Describes the first difference on stderr and returns false,
+ * or prints how many tokens agreed and returns true.
+ */
+bool CompareEngines(const char *filename);
+
+#endif
@@ -0,0 +1,582 @@
+/* File: fastscan.cc
+ * -----------------
+ * Implementation of the hand-written scanner engine.  See fastscan.h
+ * for comments, and scanner.l for the rules it follows.
+ *
+ * Positions are kept the way DoBeforeEachAction() and CountNewlines()
+ * keep them for the lexemes flex matches: a newline moves to the next
+ * line at column 0, and anything else runs from one past the last
+ * column to the end of its text.  Long stretches that produce no
+ * tokens (whitespace, comment bodies) are skipped in one go and the
+ * position worked out for where they end, using the number of
+ * newlines in them and where the last one was.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "fastscan.h"
+#include "keywords.h"
+#include "numbers.h"
+#include "scanimpl.h"
+#include "symtab.h"
+#include "strpool.h"
+#include "utility.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_VECTORS
+#endif
+
+#define STDIN_CHUNK     (64 * 1024)
+
+
+/*
+ * Type: Lines
+ * -----------
+ * The newlines seen while skipping over a stretch of input.
+ */
+typedef struct {
+    int         count;
+    const char  *last;          // the last of them, if count > 0
+} Lines;
+
+/*
+ * The skip functions each return the first byte at or after p, and
+ * before end, that the stretch they skip can't contain (or end if
+ * there is none), adding up the newlines they pass over in lines.
+ * There is a portable version of each and, on x86, SSE2 and AVX2
+ * versions picked once at startup.
+ */
+typedef const char *(*SkipFn)(const char *p, const char *end, Lines *lines);
+
+
+static inline void CountLines(const char *base, unsigned int mask, Lines *lines)
+{
+    if (mask != 0) {
+        lines->count += __builtin_popcount(mask);
+        lines->last = base + 31 - __builtin_clz(mask);
+    }
+}
+
+
+/* Whitespace is blanks, tabs and newlines. */
+static const char *SkipSpacePortable(const char *p, const char *end, Lines *lines)
+{
+    for (; p < end; p++) {
+        if (*p == '\n') {
+            lines->count++;
+            lines->last = p;
+        } else if (*p != ' ' && *p != '\t')
+            break;
+    }
+    return p;
+}
+
+/* A comment body is anything but the '*' and '/' that might close or
+ * open a comment. */
+static const char *SkipCommentPortable(const char *p, const char *end, Lines *lines)
+{
+    for (; p < end && *p != '*' && *p != '/'; p++)
+        if (*p == '\n') {
+            lines->count++;
+            lines->last = p;
+        }
+    return p;
+}
+
+/* A string body is anything but the closing quote, or the newline
+ * that makes it an error.  No newlines are passed over. */
+static const char *SkipStringPortable(const char *p, const char *end, Lines *lines)
+{
+    while (p < end && *p != '"' && *p != '\n')
+        p++;
+    return p;
+}
+
+
+#ifdef HAVE_X86_VECTORS
+
+/*
+ * Each vector version compares a block at a time against the bytes
+ * that matter and turns the results into bit masks.  Blocks may run
+ * past end (scanner input is followed by SCAN_PADDING readable bytes),
+ * but bits for bytes there are masked off.
+ */
+
+static inline unsigned int BlockMask(const char *p, const char *end, int blockSize)
+{
+    return end - p >= blockSize ? ~0u >> (32 - blockSize) : (1u << (end - p)) - 1;
+}
+
+static const char *SkipSpaceSSE2(const char *p, const char *end, Lines *lines)
+{
+    const __m128i   blank = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t'), newline = _mm_set1_epi8('\n');
+
+    for (; p < end; p += 16) {
+        __m128i         block = _mm_loadu_si128((const __m128i *) p);
+        unsigned int    valid = BlockMask(p, end, 16);
+        unsigned int    nl = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)) & valid;
+        unsigned int    space = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, blank),
+                                                               _mm_cmpeq_epi8(block, tab)));
+        unsigned int    stop = ~(space | nl) & valid;
+
+        if (stop != 0) {
+            CountLines(p, nl & ((1u << __builtin_ctz(stop)) - 1), lines);
+            return p + __builtin_ctz(stop);
+        }
+        CountLines(p, nl, lines);
+    }
+    return end;
+}
+
+static const char *SkipCommentSSE2(const char *p, const char *end, Lines *lines)
+{
+    const __m128i   star = _mm_set1_epi8('*'), slash = _mm_set1_epi8('/'), newline = _mm_set1_epi8('\n');
+
+    for (; p < end; p += 16) {
+        __m128i         block = _mm_loadu_si128((const __m128i *) p);
+        unsigned int    valid = BlockMask(p, end, 16);
+        unsigned int    nl = _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)) & valid;
+        unsigned int    stop = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, star),
+                                                              _mm_cmpeq_epi8(block, slash))) & valid;
+
+        if (stop != 0) {
+            CountLines(p, nl & ((1u << __builtin_ctz(stop)) - 1), lines);
+            return p + __builtin_ctz(stop);
+        }
+        CountLines(p, nl, lines);
+    }
+    return end;
+}
+
+static const char *SkipStringSSE2(const char *p, const char *end, Lines *lines)
+{
+    const __m128i   quote = _mm_set1_epi8('"'), newline = _mm_set1_epi8('\n');
+
+    for (; p < end; p += 16) {
+        __m128i         block = _mm_loadu_si128((const __m128i *) p);
+        unsigned int    stop = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, quote),
+                                                              _mm_cmpeq_epi8(block, newline)))
+                               & BlockMask(p, end, 16);
+
+        if (stop != 0)
+            return p + __builtin_ctz(stop);
+    }
+    return end;
+}
+
+__attribute__((target("avx2")))
+static const char *SkipSpaceAVX2(const char *p, const char *end, Lines *lines)
+{
+    const __m256i   blank = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t'), newline = _mm256_set1_epi8('\n');
+
+    for (; p < end; p += 32) {
+        __m256i         block = _mm256_loadu_si256((const __m256i *) p);
+        unsigned int    valid = BlockMask(p, end, 32);
+        unsigned int    nl = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)) & valid;
+        unsigned int    space = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, blank),
+                                                                     _mm256_cmpeq_epi8(block, tab)));
+        unsigned int    stop = ~(space | nl) & valid;
+
+        if (stop != 0) {
+            CountLines(p, nl & ((1u << __builtin_ctz(stop)) - 1), lines);
+            return p + __builtin_ctz(stop);
+        }
+        CountLines(p, nl, lines);
+    }
+    return end;
+}
+
+__attribute__((target("avx2")))
+static const char *SkipCommentAVX2(const char *p, const char *end, Lines *lines)
+{
+    const __m256i   star = _mm256_set1_epi8('*'), slash = _mm256_set1_epi8('/'), newline = _mm256_set1_epi8('\n');
+
+    for (; p < end; p += 32) {
+        __m256i         block = _mm256_loadu_si256((const __m256i *) p);
+        unsigned int    valid = BlockMask(p, end, 32);
+        unsigned int    nl = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)) & valid;
+        unsigned int    stop = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, star),
+                                                                    _mm256_cmpeq_epi8(block, slash))) & valid;
+
+        if (stop != 0) {
+            CountLines(p, nl & ((1u << __builtin_ctz(stop)) - 1), lines);
+            return p + __builtin_ctz(stop);
+        }
+        CountLines(p, nl, lines);
+    }
+    return end;
+}
+
+__attribute__((target("avx2")))
+static const char *SkipStringAVX2(const char *p, const char *end, Lines *lines)
+{
+    const __m256i   quote = _mm256_set1_epi8('"'), newline = _mm256_set1_epi8('\n');
+
+    for (; p < end; p += 32) {
+        __m256i         block = _mm256_loadu_si256((const __m256i *) p);
+        unsigned int    stop = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(block, quote),
+                                                                    _mm256_cmpeq_epi8(block, newline)))
+                               & BlockMask(p, end, 32);
+
+        if (stop != 0)
+            return p + __builtin_ctz(stop);
+    }
+    return end;
+}
+
+#endif
+
+
+typedef struct {
+    SkipFn  space, comment, string;
+} Skippers;
+
+static Skippers PickSkippers()
+{
+    Skippers    portable = {SkipSpacePortable, SkipCommentPortable, SkipStringPortable};
+#ifdef HAVE_X86_VECTORS
+    Skippers    avx2 = {SkipSpaceAVX2, SkipCommentAVX2, SkipStringAVX2};
+    Skippers    sse2 = {SkipSpaceSSE2, SkipCommentSSE2, SkipStringSSE2};
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return avx2;
+    if (__builtin_cpu_supports("sse2"))
+        return sse2;
+#endif
+    return portable;
+}
+
+// initialized once, the first time a scanner uses it, on any thread
+static const Skippers &Skip()
+{
+    static const Skippers skippers = PickSkippers();
+
+    return skippers;
+}
+
+
+/*
+ * Character classes for the scanner's definitions: LETTER, DIGIT,
+ * HEXDIGIT, the rest of an IDENTIFIER, and ONECHAR.
+ */
+enum { IsLetter = 1, IsDigit = 2, IsHexDigit = 4, IsIdentChar = 8, IsOneChar = 16 };
+
+static unsigned char gClass[256];
+
+static bool InitClasses()
+{
+    const char  *p;
+    int         c;
+
+    for (c = 'a'; c <= 'z'; c++)
+        gClass[c] = gClass[c - 'a' + 'A'] = IsLetter | IsIdentChar;
+    for (c = '0'; c <= '9'; c++)
+        gClass[c] = IsDigit | IsHexDigit | IsIdentChar;
+    for (c = 'a'; c <= 'f'; c++)
+        gClass[c] |= IsHexDigit, gClass[c - 'a' + 'A'] |= IsHexDigit;
+    gClass['_'] = IsIdentChar;
+    for (p = "+-*/%\\<>=;,.![](){}"; *p; p++)
+        gClass[(unsigned char)*p] |= IsOneChar;
+    return true;
+}
+
+static bool gClassesReady = InitClasses();
+
+static inline bool Is(char c, int cls)
+{
+    return gClass[(unsigned char)c] & cls;
+}
+
+
+/*
+ * Function: Match()
+ * -----------------
+ * Makes the length characters at the cursor the current lexeme:
+ * null-terminates it, moves the position over it the way
+ * DoBeforeEachAction() would, and moves the cursor past it.
+ */
+static inline void Match(Scanner scanner, int length)
+{
+    scanner->text = scanner->cursor;
+    scanner->textLength = length;
+    scanner->cursor += length;
+    scanner->holdAt = scanner->cursor;
+    scanner->holdChar = *scanner->cursor;
+    *scanner->cursor = '\0';
+
+    scanner->loc.first_column = scanner->loc.last_column + 1;
+    scanner->loc.last_column += length;
+}
+
+/* Puts back the byte Match() overwrote. */
+static inline void Unhold(Scanner scanner)
+{
+    if (scanner->holdAt != NULL) {
+        *scanner->holdAt = scanner->holdChar;
+        scanner->holdAt = NULL;
+    }
+}
+
+
+/*
+ * Function: SkipOver()
+ * --------------------
+ * Moves the cursor to stop, over a stretch of lexemes that produce no
+ * tokens.  If oneLexeme, the blanks and tabs on each line of it are a
+ * single lexeme each, as for WHITESPACE; otherwise every character is
+ * its own, as in a comment body.
+ */
+static inline void SkipOver(Scanner scanner, const char *stop, Lines *lines, bool oneLexeme)
+{
+    int     length;
+
+    if (lines->count > 0) {
+        scanner->loc.first_line += lines->count;
+        length = stop - (lines->last + 1);
+        scanner->loc.first_column = (length > 0 ? (oneLexeme ? 1 : length) : 0);
+        scanner->loc.last_column = length;
+    } else if ((length = stop - scanner->cursor) > 0) {
+        scanner->loc.first_column = (oneLexeme ? scanner->loc.last_column + 1
+                                               : scanner->loc.last_column + length);
+        scanner->loc.last_column += length;
+    }
+    scanner->cursor = (char *) stop;
+}
+
+
+/*
+ * Function: SkipComment()
+ * -----------------------
+ * Scans on through comments until the outermost one ends, as the
+ * <COMMENT> rules do.  Returns false if the input ends first.  None of
+ * these lexemes is ever returned, so they aren't null-terminated.
+ */
+static bool SkipComment(Scanner scanner)
+{
+    const char  *stop;
+    Lines       lines;
+    int         length;
+
+    for (;;) {
+        lines.count = 0;
+        stop = Skip().comment(scanner->cursor, scanner->inputEnd, &lines);
+        SkipOver(scanner, stop, &lines, false);
+        if (stop == scanner->inputEnd)
+            return false;
+
+        length = 1;
+        if (stop[0] == '*' && stop[1] == '/') {
+            length = 2;
+            scanner->commentDepth--;
+        } else if (stop[0] == '/' && stop[1] == '*') {
+            length = 2;
+            scanner->commentDepth++;
+        }
+        scanner->cursor += length;
+        scanner->loc.first_column = scanner->loc.last_column + 1;
+        scanner->loc.last_column += length;
+        if (scanner->commentDepth == 0)
+            return true;
+    }
+}
+
+
+/*
+ * Function: MatchNumber()
+ * -----------------------
+ * Matches the longest of DECIMALINT, HEXINT and DOUBLECONSTANT at the
+ * cursor, which is at a digit, and returns its token.
+ */
+static int MatchNumber(Scanner scanner)
+{
+    const char  *p = scanner->cursor, *q, *d;
+    int         length, token = T_IntConstant;
+    bool        hex = false;
+
+    for (q = p; Is(*q, IsDigit); q++)
+        ;
+    length = q - p;
+
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && Is(p[2], IsHexDigit)) {
+        for (d = p + 2; Is(*d, IsHexDigit); d++)
+            ;
+        length = d - p;
+        hex = true;
+    } else if (*q == '.') {
+        for (d = q + 1; Is(*d, IsDigit); d++)
+            ;
+        if ((d[0] == 'E' || d[0] == 'e') && (d[1] == '+' || d[1] == '-') && Is(d[2], IsDigit))
+            for (d += 2; Is(*d, IsDigit); d++)
+                ;
+        length = d - p;
+        token = T_DoubleConstant;
+    }
+
+    // converted, and reported out of range, as the flex actions do
+    Match(scanner, length);
+    if (token == T_DoubleConstant) {
+        if (!ParseDouble(scanner->text, length, &scanner->value.doubleConstant))
+            ReportError(&scanner->loc, "Double constant out of range: %.*s",
+                        QuotedLength(length), scanner->text);
+    } else if (!(hex ? ParseHexInt(scanner->text, length, &scanner->value.integerConstant)
+                     : ParseDecimalInt(scanner->text, length, &scanner->value.integerConstant))) {
+        ReportError(&scanner->loc, "Integer constant out of range: %.*s",
+                    QuotedLength(length), scanner->text);
+    }
+    return token;
+}
+
+
+/*
+ * Function: TwoCharToken()
+ * ------------------------
+ * Returns the token for the operator made of c followed by next, or 0
+ * if the two don't make one.
+ */
+static inline int TwoCharToken(char c, char next)
+{
+    switch (c) {
+      case '&': return next == '&' ? T_And : 0;
+      case '|': return next == '|' ? T_Or : 0;
+      case '<': return next == '=' ? T_LessEqual : 0;
+      case '>': return next == '=' ? T_GreaterEqual : 0;
+      case '=': return next == '=' ? T_Equal : 0;
+      case '!': return next == '=' ? T_NotEqual : 0;
+    }
+    return 0;
+}
+
+
+void FastScanStart(Scanner scanner)
+{
+    size_t      length = 0, capacity = 0;
+    ssize_t     n;
+
+    if (scanner->input == NULL) {
+        // read all of stdin, leaving room for the terminators and padding
+        do {
+            if (capacity - length < STDIN_CHUNK + 2 + SCAN_PADDING) {
+                capacity = 2 * capacity + STDIN_CHUNK + 2 + SCAN_PADDING;
+                scanner->ownedInput = (char *) realloc(scanner->ownedInput, capacity);
+                Assert(scanner->ownedInput != NULL);
+            }
+            n = read(STDIN_FILENO, scanner->ownedInput + length, STDIN_CHUNK);
+            if (n < 0)
+                Failure("Can't read stdin: %s", strerror(errno));
+            length += n;
+        } while (n > 0);
+        memset(scanner->ownedInput + length, 0, 2 + SCAN_PADDING);
+        scanner->ownedSize = capacity;
+        scanner->stableInput = true;
+        scanner->input = scanner->ownedInput;
+        scanner->inputEnd = scanner->input + length;
+    }
+    scanner->cursor = scanner->input;
+    scanner->holdAt = NULL;
+}
+
+
+int FastScanNextToken(Scanner scanner)
+{
+    const char  *p, *stop;
+    Lines       lines;
+    int         token;
+
+    for (;;) {
+        Unhold(scanner);
+
+        if (scanner->commentDepth > 0 && !SkipComment(scanner)) {
+            // a chunk may stop inside a comment that the next one ends
+            if (!scanner->endsMidFile)
+                ReportError(&scanner->loc, "Input ends with unterminated comment");
+            return 0;
+        }
+
+        p = scanner->cursor;
+        if (p >= scanner->inputEnd)
+            return 0;
+
+        switch (*p) {
+          case ' ':
+          case '\t':
+            // most runs are a blank or two between tokens on one line,
+            // too short to be worth the vector code
+            for (stop = p + 1; *stop == ' ' || *stop == '\t'; stop++)
+                ;
+            if (*stop != '\n') {
+                lines.count = 0;
+                SkipOver(scanner, stop, &lines, true);
+                continue;
+            }
+            // fall through
+          case '\n':
+            lines.count = 0;
+            stop = Skip().space(p, scanner->inputEnd, &lines);
+            SkipOver(scanner, stop, &lines, true);
+            continue;
+
+          case '/':
+            if (p[1] == '*') {
+                Match(scanner, 2);
+                scanner->commentDepth = 1;
+                continue;
+            }
+            // a // comment needs the newline after it, as $ does
+            if (p[1] == '/'
+                && (stop = (const char *) memchr(p, '\n', scanner->inputEnd - p)) != NULL) {
+                Match(scanner, stop - p);
+                continue;
+            }
+            Match(scanner, 1);
+            return '/';
+
+          case '"':
+            stop = Skip().string(p + 1, scanner->inputEnd, &lines);
+            if (stop < scanner->inputEnd && *stop == '"') {
+                Match(scanner, stop + 1 - p);
+                scanner->value.stringConstant = scanner->strings->Intern(scanner->text,
+                                                        scanner->textLength, scanner->stableInput);
+                scanner->numStringTokens++;
+                scanner->lexemeBytes += scanner->textLength;
+                return T_StringConstant;
+            }
+            Match(scanner, stop - p);
+            ReportError(&scanner->loc, "Illegal newline in string constant %s", scanner->text);
+            continue;
+        }
+
+        if (Is(*p, IsLetter)) {
+            for (stop = p + 1; Is(*stop, IsIdentChar); stop++)
+                ;
+            Match(scanner, stop - p);
+            if ((token = KeywordToken(scanner->text, scanner->textLength)) != 0) {
+                if (token == T_BoolConstant)
+                    scanner->value.boolConstant = (scanner->text[0] == 't');
+                return token;
+            }
+            scanner->numIdentTokens++;
+            scanner->lexemeBytes += scanner->textLength;
+            scanner->value.decl = scanner->symbols->Intern(scanner->text, scanner->textLength,
+                                                          scanner->loc.first_line);
+            return T_Identifier;
+        }
+
+        if (Is(*p, IsDigit))
+            return MatchNumber(scanner);
+
+        if ((token = TwoCharToken(p[0], p[1])) != 0) {
+            Match(scanner, 2);
+            return token;
+        }
+
+        Match(scanner, 1);
+        if (Is(*p, IsOneChar))
+            return (unsigned char) *p;
+        ReportError(&scanner->loc, "Unrecognized char: '%c'", scanner->text[0]);
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * File: fastscan.h
+ * ----------------
+ * The hand-written scanner engine (FastEngine in scanner.h).  It follows
+ * the rules in scanner.l exactly, including flex's longest-match and
+ * first-rule tie breaking, so that it returns the same tokens, yylval,
+ * yylloc and errors as the generated scanner.  Where the generated
+ * scanner takes one table transition per byte, it classifies 16 or 32
+ * bytes at a time with SSE2 or AVX2 (whichever the CPU has) to skip
+ * whitespace, comment bodies and string bodies.  pp1 -e check compares
+ * the two engines on a file.
+ *
+ * These are called by the Scanner functions in scanner.l, not by
+ * clients.
+ */
+
+#ifndef _H_fastscan
+#define _H_fastscan
+
+#include "scanner.h"
+
+/*
+ * Function: FastScanStart()
+ * -------------------------
+ * Gets a new scanner's input ready for the fast engine, reading all of
+ * stdin into memory if the scanner has no input file.
+ */
+void FastScanStart(Scanner scanner);
+
+/*
+ * Function: FastScanNextToken()
+ * -----------------------------
+ * The fast engine's ScannerNextToken().
+ */
+int FastScanNextToken(Scanner scanner);
+
+#endif
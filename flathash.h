@@ -0,0 +1,176 @@
+/*
+ * File: flathash.h
+ * ----------------
+ * FlatHashTable<T, Hash, Equal> is a hash table of T, the typed
+ * counterpart of the HashTable in hash.h.  As there, the elements are
+ * their own keys: a table of Declarations is looked up by name.  The
+ * element type and the hash and equality functions are template
+ * parameters, so both inline into every probe, and elements are moved
+ * into the table rather than copied as bytes.
+ *
+ * Hash is a function object with a HashCode operator() for T and for
+ * every other type of key that elements are looked up by, and Equal one
+ * with a bool operator()(const T &elem, const K &key) for each such key
+ * type K, T included.  Both are constructed with the table and may carry
+ * state.
+ *
+ * The table works as SymbolTable does: open addressing with linear
+ * probing over a flat array of slots, each caching the full hash of its
+ * element, with a power-of-two capacity that doubles past three quarters
+ * full.  Elements are stored in the slots, so pointers to them are good
+ * only until the next Enter().
+ */
+
+#ifndef _H_flathash
+#define _H_flathash
+
+#include <assert.h>
+#include <stdlib.h>
+#include <new>
+#include <utility>
+#include "utility.h"
+
+template <typename T, typename Hash, typename Equal>
+class FlatHashTable
+{
+  private:
+    struct Slot {
+        HashCode hash;          // hash of the element, kept so probes
+                                // and Grow() don't have to redo it
+        bool full;              // false if the slot is empty
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *Elem() { return reinterpret_cast<T *>(storage); }
+    };
+
+    Slot *slots;
+    int capacity;               // number of slots, always a power of two
+    int count;                  // number of full slots
+    Hash hash;
+    Equal equal;
+
+    static Slot *NewSlots(int n)
+    {
+        Slot    *s = (Slot *) malloc(n * sizeof(Slot));
+        int     i;
+
+        Assert(s != NULL);
+        for (i = 0; i < n; i++)
+            s[i].full = false;
+        return s;
+    }
+
+    /* Returns the slot holding the element equal to key, or the empty
+     * slot where it would go. */
+    template <typename K>
+    Slot *FindSlot(const K &key, HashCode h)
+    {
+        int     mask = capacity - 1;
+        int     i = (int)(h & mask);
+
+        // the load factor guarantees an empty slot, so this ends
+        while (slots[i].full && (slots[i].hash != h || !equal(*slots[i].Elem(), key)))
+            i = (i + 1) & mask;
+        return &slots[i];
+    }
+
+    void Grow()
+    {
+        Slot    *old = slots;
+        int     oldCapacity = capacity;
+        int     i, j, mask;
+
+        capacity *= 2;
+        mask = capacity - 1;
+        slots = NewSlots(capacity);
+        for (i = 0; i < oldCapacity; i++) {
+            if (!old[i].full)
+                continue;
+            // the elements are all different, so only the empty
+            // slot needs finding, and no element is compared
+            for (j = (int)(old[i].hash & mask); slots[j].full; j = (j + 1) & mask)
+                ;
+            slots[j].hash = old[i].hash;
+            slots[j].full = true;
+            new(slots[j].storage) T(std::move(*old[i].Elem()));
+            old[i].Elem()->~T();
+        }
+        free(old);
+    }
+
+  public:
+
+    /* Makes an empty table with room for at least sizeHint elements
+     * before it needs to grow. */
+    FlatHashTable(int sizeHint = 0, const Hash &hashFn = Hash(), const Equal &equalFn = Equal())
+        : count(0), hash(hashFn), equal(equalFn)
+    {
+        assert(sizeHint >= 0);
+        // keep the load factor at or below 3/4 for sizeHint entries
+        for (capacity = 16; capacity * 3 < sizeHint * 4; capacity *= 2)
+            ;
+        slots = NewSlots(capacity);
+    }
+
+    /* Destroys every element and frees the slots. */
+    ~FlatHashTable()
+    {
+        int     i;
+
+        for (i = 0; i < capacity; i++)
+            if (slots[i].full)
+                slots[i].Elem()->~T();
+        free(slots);
+    }
+
+    FlatHashTable(const FlatHashTable &) = delete;
+    FlatHashTable &operator=(const FlatHashTable &) = delete;
+
+    /* Returns the number of elements in the table. */
+    int Count() const { return count; }
+
+    /* Returns the element equal to key, or NULL if there is none. */
+    template <typename K>
+    T *Lookup(const K &key)
+    {
+        Slot    *slot = FindSlot(key, hash(key));
+
+        return slot->full ? slot->Elem() : NULL;
+    }
+
+    /* Adds elem to the table, in place of the element equal to it if
+     * there is one, and returns the table's copy. */
+    T *Enter(T elem)
+    {
+        HashCode    h = hash(elem);
+        Slot        *slot = FindSlot(elem, h);
+
+        if (slot->full) {
+            *slot->Elem() = std::move(elem);
+            return slot->Elem();
+        }
+        if ((count + 1) * 4 > capacity * 3) {
+            Grow();
+            slot = FindSlot(elem, h);
+        }
+        slot->hash = h;
+        slot->full = true;
+        new(slot->storage) T(std::move(elem));
+        count++;
+        return slot->Elem();
+    }
+
+    /* Calls fn on every element in the table, in no particular
+     * order. */
+    template <typename Fn>
+    void Map(Fn fn)
+    {
+        int     i;
+
+        for (i = 0; i < capacity; i++)
+            if (slots[i].full)
+                fn(*slots[i].Elem());
+    }
+};
+
+#endif
@@ -0,0 +1,342 @@
+// hash.cc by Suzanne Aldrich
+// borrowed for CS143 from hashtable.c and darray.c for CS107
+//
+// The HashTable and DArray here are now a thin layer over the typed
+// FlatHashTable and Vector templates (flathash.h, vector.h), kept so
+// that code written against the void * interface still works.  New code
+// should use the templates directly, which inline the client's hash and
+// compare and move elements instead of copying their bytes.
+
+#include <assert.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+#include "arena.h"
+#include "flathash.h"
+#include "vector.h"
+
+// the number of buckets client hash functions are asked to hash into:
+// a prime near 2^31, so that the result is as good as a full hash code
+#define HASH_RANGE 2147483647
+
+
+/*
+ * The FlatHashTable holds pointers to the elements, which are copied
+ * into an arena so that they stay put as the table grows.  An element
+ * entered in place of an equal one is copied over it.
+ */
+struct ElemHash {
+    TableHashFn         fn;
+
+    HashCode operator()(const void *elem) const
+    {
+        return (HashCode)(*fn)(elem, HASH_RANGE);
+    }
+};
+
+struct ElemEqual {
+    TableCompareFn      fn;
+
+    bool operator()(const void *elem, const void *key) const
+    {
+        return (*fn)(elem, key) == 0;
+    }
+};
+
+struct HashImplementation {
+    FlatHashTable<void *, ElemHash, ElemEqual> elems;
+    Arena               storage;        // the elements themselves
+    int                 elemSize;       // byte size of each element
+    TableElementFreeFn  freeFn;         // client element clean up function
+
+    HashImplementation(int elemSize, int sizeHint, TableHashFn hashFn, TableCompareFn compFn,
+                       TableElementFreeFn freeFn)
+        : elems(sizeHint, ElemHash{hashFn}, ElemEqual{compFn}),
+          storage(ArenaNew(0)), elemSize(elemSize), freeFn(freeFn) {}
+};
+
+
+HashTable TableNew(int elemSize, int nBuckets, TableHashFn hashFn, TableCompareFn compFn, TableElementFreeFn freeFn)
+{
+    assert(elemSize > 0);
+    assert(nBuckets > 0);
+    assert(hashFn != NULL);
+    assert(compFn != NULL);
+
+    // nBuckets is taken as the expected number of elements
+
+    return new HashImplementation(elemSize, nBuckets, hashFn, compFn, freeFn);
+}
+
+
+void TableFree(HashTable table)
+{
+    assert(table != NULL);
+
+    if (table->freeFn != NULL) {
+        TableElementFreeFn freeFn = table->freeFn;
+        table->elems.Map([freeFn](void *elem) { (*freeFn)(elem); });
+    }
+    ArenaFree(table->storage);
+    delete table;
+}
+
+
+int TableCount(HashTable table)
+{
+    assert(table != NULL);
+    return table->elems.Count();
+}
+
+
+void TableEnter(HashTable table, const void *newElem)
+{
+    void    **match;
+    void    *elem;
+
+    assert(table != NULL);
+    assert(newElem != NULL);
+
+    // replace a matching element, or copy in a new one
+
+    if ((match = table->elems.Lookup(newElem)) != NULL) {
+        if (table->freeFn != NULL)
+            (*table->freeFn)(*match);
+        memcpy(*match, newElem, table->elemSize);
+        return;
+    }
+    elem = ArenaAlloc(table->storage, table->elemSize);
+    memcpy(elem, newElem, table->elemSize);
+    table->elems.Enter(elem);
+}
+
+
+void *TableLookup(HashTable table, const void *elemKey)
+{
+    void    **match;
+
+    assert(table != NULL);
+    assert(elemKey != NULL);
+
+    match = table->elems.Lookup(elemKey);
+    return match != NULL ? *match : NULL;
+}
+
+
+void TableMap(HashTable table, TableMapFn fn, void *clientData)
+{
+    assert(table != NULL);
+    assert(fn != NULL);
+
+    table->elems.Map([fn, clientData](void *elem) { (*fn)(elem, clientData); });
+}
+
+/* File: darray.c
+ * --------------
+ * Implementation of the dynamic array interface, as a Vector of the
+ * elements' bytes.  The first INLINE_BYTES of them are kept in the
+ * DArray itself, so a short array takes one allocation, not two.
+ */
+
+#define INLINE_BYTES 32
+
+
+struct DArrayImplementation {
+    Vector<char, INLINE_BYTES> bytes;   // the elements, elemSize bytes each
+    int                 elemSize;       // byte size of each element
+    ArrayElementFreeFn  elemFreeFn;     // client element clean up function
+
+    DArrayImplementation(int elemSize, int numElems, ArrayElementFreeFn elemFreeFn)
+        : bytes(numElems * elemSize), elemSize(elemSize), elemFreeFn(elemFreeFn) {}
+};
+
+
+DArray ArrayNew(int elemSize, int numElemsToAllocate, ArrayElementFreeFn elemFreeFn)
+{
+    assert(numElemsToAllocate >= 0);
+    assert(elemSize > 0);
+
+    return new DArrayImplementation(elemSize, numElemsToAllocate, elemFreeFn);
+}
+
+
+static void ArrayElemFree(DArray array, int n)
+{
+    assert(array != NULL);
+
+    // free elements using client-supplied function if needed
+
+    if (array->elemFreeFn != NULL)
+        (*array->elemFreeFn)(ArrayNth(array, n));
+}
+
+
+void ArrayFree(DArray array)
+{
+    int     n;
+
+    assert(array != NULL);
+    for (n = ArrayLength(array)-1; n >= 0; n--)
+        ArrayElemFree(array, n);
+    delete array;
+}
+
+
+int ArrayLength(const DArray array)
+{
+    assert(array != NULL);
+    return array->bytes.Length() / array->elemSize;
+}
+
+
+void *ArrayNth(DArray array, int n)
+{
+    assert(array != NULL);
+    assert(0 <= n && n < ArrayLength(array));
+
+    return &array->bytes[n * array->elemSize];
+}
+
+
+void ArrayReserve(DArray array, int numElems)
+{
+    assert(array != NULL);
+    assert(numElems >= 0);
+
+    // make room for numElems in all, so appends up to there don't move
+
+    array->bytes.Reserve(numElems * array->elemSize);
+}
+
+
+void ArrayAppend(DArray array, const void *newElem)
+{
+    assert(array != NULL);
+
+    // insert element at the end of the array
+
+    ArrayInsertAt(array, newElem, ArrayLength(array));
+}
+
+
+void ArrayAppendRange(DArray array, const void *newElems, int numElems)
+{
+    assert(array != NULL);
+
+    // insert elements at the end of the array
+
+    ArrayInsertRangeAt(array, newElems, numElems, ArrayLength(array));
+}
+
+
+void ArrayInsertAt(DArray array, const void *newElem, int n)
+{
+    ArrayInsertRangeAt(array, newElem, 1, n);
+}
+
+
+void ArrayInsertRangeAt(DArray array, const void *newElems, int numElems, int n)
+{
+    assert(array != NULL);
+    assert(newElems != NULL);
+    assert(numElems >= 0);
+    assert(0 <= n && n <= ArrayLength(array));
+
+    // the tail is shifted up once for all of them
+
+    array->bytes.InsertRange((const char *)newElems, numElems * array->elemSize,
+                             n * array->elemSize);
+}
+
+
+void ArrayDeleteAt(DArray array, int n)
+{
+    assert(array != NULL);
+
+    // free contents of element, then cover it
+
+    ArrayElemFree(array, n);
+    array->bytes.DeleteRange(n * array->elemSize, array->elemSize);
+}
+
+
+void ArrayReplaceAt(DArray array, const void *newElem, int n)
+{
+    assert(array != NULL);
+    assert(newElem != NULL);
+
+    // free contents of old element and cover it with new element
+
+    ArrayElemFree(array, n);
+    memcpy(ArrayNth(array, n), newElem, array->elemSize);
+}
+
+
+void ArraySort(DArray array, ArrayCompareFn comparator)
+{
+    assert(array != NULL);
+    assert(comparator != NULL);
+
+    // sort array!
+
+    qsort(array->bytes.begin(), ArrayLength(array), array->elemSize, comparator);
+}
+
+
+int ArraySearch(DArray array, const void *key, ArrayCompareFn comparator, int fromIndex, bool isSorted)
+{
+    int     n;
+    void    *foundPtr = NULL;
+
+    assert(array != NULL);
+    assert(key != NULL);
+    assert(comparator != NULL);
+
+    // find nothing in an empty array
+
+    if (fromIndex == ArrayLength(array)) return NOT_FOUND;
+
+    // find pointer to element which matches key
+
+    if(isSorted) {
+
+        // binary search sorted array
+
+        foundPtr = bsearch(key, ArrayNth(array, fromIndex), ArrayLength(array) - fromIndex, array->elemSize, comparator);
+    } else {
+
+        // linear search unsorted array
+
+        for(n = fromIndex; n < ArrayLength(array); n++) {
+
+            // compare elements using client-supplied function
+
+            if ((*comparator)(ArrayNth(array, n), key) == 0) {
+                foundPtr = ArrayNth(array, n);
+                break;
+            }
+        }
+    }
+
+    // if pointer wasn't set, found nothing
+
+    if (foundPtr == NULL) return NOT_FOUND;
+
+    // cast pointer to char for byte math and calculate array index
+
+    return ((char *)foundPtr - array->bytes.begin()) / array->elemSize;
+}
+
+
+void ArrayMap(DArray array, ArrayMapFn fn, void *clientData)
+{
+    int     n;
+
+    assert(array != NULL);
+    assert(fn != NULL);
+
+	// iterate over array and apply client-supplied function to each element
+
+	for (n = 0; n < ArrayLength(array); n++) (*fn)(ArrayNth(array, n), clientData);
+}
@@ -1,5 +1,9 @@
 // hash.h by Suzanne Aldrich
 // borrowed for CS143 from hashtable.h and darray.h for CS107
+//
+// The void * interface, kept for compatibility.  Both types are built on
+// the typed templates in flathash.h and vector.h, which C++ code should
+// use instead.  nBuckets is now only a hint at the number of elements.
 
 #include <stdio.h>
 
@@ -32,7 +36,7 @@ void *TableLookup(HashTable table, const void *elemKey);
 void TableMap(HashTable table, TableMapFn fn, void *clientData);
 
 
-#endif _HASHTABLE_H
+#endif // _HASHTABLE_H
 
 #ifndef _DARRAY_H
 #define _DARRAY_H
@@ -57,10 +61,16 @@ int ArrayLength(const DArray array);
 
 void *ArrayNth(DArray array, int n);
 
+void ArrayReserve(DArray array, int numElems);
+
 void ArrayAppend(DArray array, const void *newElem);
 
+void ArrayAppendRange(DArray array, const void *newElems, int numElems);
+
 void ArrayInsertAt(DArray array, const void *newElem, int n);
 
+void ArrayInsertRangeAt(DArray array, const void *newElems, int numElems, int n);
+
 void ArrayDeleteAt(DArray array, int n);
 
 void ArrayReplaceAt(DArray array, const void *newElem, int n);
@@ -74,5 +84,5 @@ int ArraySearch(DArray array, const void *key, ArrayCompareFn comparator,
 
 void ArrayMap(DArray array, ArrayMapFn fn, void *clientData);
 
-#endif _DARRAY_
+#endif // _DARRAY_H
 
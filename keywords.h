@@ -0,0 +1,163 @@
+/*
+ * File: keywords.h
+ * ----------------
+ * Recognition of Decaf's reserved words (and the boolean constants
+ * true and false, which look the same).  Instead of a rule of its own
+ * for each one, the scanner matches them all as identifiers and then
+ * asks KeywordToken() whether the identifier is really a keyword.
+ *
+ * That takes one hash and one compare: the keywords are laid out in a
+ * small table by a perfect hash, found by the compiler, so that no two
+ * land in the same slot.  The hash only looks at the length and the
+ * first and last characters, which are already different for every
+ * keyword.  An identifier that isn't a keyword either hashes to an
+ * empty slot or fails the compare against the one keyword in its slot.
+ */
+
+#ifndef _H_keywords
+#define _H_keywords
+
+#include <string.h>
+#include "scanner.h"
+
+#define KEYWORD_SLOT_BITS   6           // table of 64 slots
+
+
+/*
+ * Type: Keyword
+ * -------------
+ * A reserved word and the token the scanner returns for it.
+ */
+typedef struct {
+    const char  *word;
+    int         length;                 // 0 in an empty table slot
+    TokenType   token;
+} Keyword;
+
+/*
+ * The reserved words, each with its token.  Every TokenType that is
+ * spelled one fixed way as a word must appear here exactly once, which
+ * BuildKeywordTable() checks.
+ */
+static constexpr Keyword gKeywords[] = {
+    {"void", 4, T_Void}, {"int", 3, T_Int}, {"double", 6, T_Double},
+    {"bool", 4, T_Bool}, {"string", 6, T_String}, {"class", 5, T_Class},
+    {"null", 4, T_Null}, {"while", 5, T_While}, {"if", 2, T_If},
+    {"else", 4, T_Else}, {"return", 6, T_Return}, {"public", 6, T_Public},
+    {"private", 7, T_Private}, {"extends", 7, T_Extends}, {"this", 4, T_This},
+    {"New", 3, T_New}, {"NewArray", 8, T_NewArray}, {"Print", 5, T_Print},
+    {"ReadInteger", 11, T_ReadInteger}, {"ReadLine", 8, T_ReadLine},
+    {"true", 4, T_BoolConstant}, {"false", 5, T_BoolConstant},
+};
+
+#define NUM_KEYWORDS    ((int)(sizeof(gKeywords) / sizeof(gKeywords[0])))
+
+
+static constexpr unsigned int KeywordKey(const char *text, int length)
+{
+    return (unsigned char)text[0] | (unsigned char)text[length - 1] << 8 | (unsigned int)length << 16;
+}
+
+static constexpr unsigned int KeywordSlot(unsigned int key, unsigned int seed)
+{
+    return (key * seed) >> (32 - KEYWORD_SLOT_BITS);
+}
+
+
+/*
+ * Type: KeywordTable
+ * ------------------
+ * The keywords by slot, and the multiplier that puts each one in its
+ * own slot.
+ */
+typedef struct {
+    unsigned int    seed;               // 0 if none was found
+    Keyword         slots[1 << KEYWORD_SLOT_BITS];
+} KeywordTable;
+
+/*
+ * Function: BuildKeywordTable()
+ * -----------------------------
+ * Tries odd multipliers until one sends every keyword to a different
+ * slot, and lays the keywords out with it.  Only ever run by the
+ * compiler.
+ */
+static constexpr KeywordTable BuildKeywordTable()
+{
+    KeywordTable    table = {};
+    unsigned int    seed = 0, slot = 0;
+    int             i = 0, tries = 0;
+
+    // every word-like token is a keyword, and only once (true and
+    // false are the two spellings of T_BoolConstant)
+    for (int token = T_Void; token < T_NumTokenTypes; token++) {
+        int uses = 0;
+
+        for (i = 0; i < NUM_KEYWORDS; i++) {
+            uses += (gKeywords[i].token == token);
+            if (gKeywords[i].word[gKeywords[i].length] != '\0')
+                return table;       // length is wrong
+        }
+        switch (token) {
+          case T_LessEqual: case T_GreaterEqual: case T_Equal: case T_NotEqual:
+          case T_And: case T_Or: case T_Identifier: case T_StringConstant:
+          case T_IntConstant: case T_DoubleConstant:
+            if (uses != 0)
+                return table;
+            break;
+          case T_BoolConstant:
+            if (uses != 2)
+                return table;
+            break;
+          default:
+            if (uses != 1)
+                return table;
+            break;
+        }
+    }
+
+    for (seed = 0x9E3779B1u, tries = 0; tries < 100000; seed += 2, tries++) {
+        bool used[1 << KEYWORD_SLOT_BITS] = {};
+
+        for (i = 0; i < NUM_KEYWORDS; i++) {
+            slot = KeywordSlot(KeywordKey(gKeywords[i].word, gKeywords[i].length), seed);
+            if (used[slot])
+                break;
+            used[slot] = true;
+        }
+        if (i < NUM_KEYWORDS)
+            continue;
+
+        table.seed = seed;
+        for (i = 0; i < NUM_KEYWORDS; i++)
+            table.slots[KeywordSlot(KeywordKey(gKeywords[i].word, gKeywords[i].length), seed)] = gKeywords[i];
+        return table;
+    }
+    return table;
+}
+
+static constexpr KeywordTable gKeywordTable = BuildKeywordTable();
+
+static_assert(gKeywordTable.seed != 0,
+              "gKeywords doesn't match TokenType, or has no perfect hash");
+
+
+/*
+ * Function: KeywordToken()
+ * Usage: if ((token = KeywordToken(yytext, yyleng)) != 0) return token;
+ * ---------------------------------------------------------------------
+ * Returns the token for the reserved word spelled by the length
+ * characters at text (T_BoolConstant for true and false), or 0 if they
+ * spell an ordinary identifier.  length must be at least 1.
+ */
+static inline int KeywordToken(const char *text, int length)
+{
+    const Keyword   *keyword;
+
+    keyword = &gKeywordTable.slots[KeywordSlot(KeywordKey(text, length), gKeywordTable.seed)];
+    if (keyword->length == length && memcmp(keyword->word, text, length) == 0)
+        return keyword->token;
+    return 0;
+}
+
+#endif
@@ -7,63 +7,145 @@
 #include "scanner.h"
 #include "utility.h"
 #include "declaration.h"
+#include "tokenstream.h"
+#include "driver.h"
+#include "tokencache.h"
+#include "profile.h"
+#include "symdict.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
 
 static void ParseCommandLine(int argc, char *argv[]);
+static void Usage();
 
+static bool gBinaryOutput = false;  // -b: write a binary token stream
+static char **gInputFiles = NULL;   // files to scan, none for stdin
+static int gNumInputFiles = 0;
+static int gNumThreads = 0;         // -j: threads for the multi-file driver
+static bool gCheckEngines = false;  // -e check: compare the scanner engines
+static char *gCacheDirectory = NULL; // -c: token cache to use, if any
+static long gMemoryBudget = 0;      // -m: stream in this much memory
+static char *gDictionaryFile = NULL; // -D: shared symbol dictionary, if any
+static bool gFastEngine = false;    // -e fast
 
 
-/*
- * Function: PrintOneToken()
- * Usage: PrintOneToken(T_Double, "3.5", val, loc);
- * -----------------------------------------------
- * We supply this function to print information about the tokens returned
- * by the lexer as part of pp1.  Do not modifiy it.
- */
-static void PrintOneToken(TokenType token, char *text, YYSTYPE value, yyltype loc)
-{
-  char buffer[] = {'\'', token, '\'', '\0'};
-  const char *name = token >= T_Void ? gTokenNames[token - T_Void] : buffer;
-  
-  printf("%-12s line %d cols %d-%d is %s ", text,
-	   loc.first_line, loc.first_column, loc.last_column, name);
-  
-  switch(token) {
-    case T_IntConstant:     
-      printf("(value = %d)\n", value.integerConstant); break;
-    case T_DoubleConstant:   
-      printf("(value = %g)\n", value.doubleConstant); break;
-    case T_StringConstant:  
-      printf("(value = %s)\n", value.stringConstant); break;
-    case T_BoolConstant:    
-      printf("(value = %s)\n", value.boolConstant ? "true" : "false"); break;
-    case T_Identifier: 
-      value.decl->Print(); break;
-    default:
-      printf("\n"); break;
-  }
-}
-
 
 /*
  * Function: main()
  * ----------------
  * Entry point to the entire program.  We parse the command line and turn
  * on any debugging flags requested by the user when invoking the program.
- * Call Inityylex() to set up the scanner, and then loop, using yylex()
+ * Call Inityylex() to set up the scanner (on the input file, if one was
+ * named, otherwise on stdin), and then loop, using yylex()
  * to get each token, print out its information, and continue until the
- * entire input has been scanned.
+ * entire input has been scanned.  Finishyylex() then releases the
+ * scanner's storage.  With -b, tokens (and error messages, in order)
+ * go to stdout as a binary token stream instead of text; pp1decode
+ * turns that back into the text format.
+ *
+ * Given several files, pp1 instead hands them to the multi-file driver
+ * (see driver.h), which scans them in parallel and prints the
+ * identifier statistics of all of them combined.  Given one file and
+ * -j, it scans chunks of the file in parallel, with the same output as
+ * scanning it in one go.
+ *
+ * -e picks the scanner engine (see scanner.h) for any of these.  -e
+ * check instead scans one file with both engines and reports whether
+ * they agree.
+ *
+ * -c names a token cache directory (see tokencache.h).  A file found
+ * there is replayed rather than scanned, and one that isn't is stored
+ * there once it has been scanned, except when it is scanned in chunks.
+ *
+ * -m streams the input through a scanner that keeps its storage under
+ * a budget (see ScannerSetMemoryBudget()), for input that never ends,
+ * such as the output of another program piped into pp1.
+ *
+ * -D names a symbol dictionary made by pp1dict (see symdict.h), which
+ * every scanner looks identifiers up in first.
+ *
+ * A profiling build (see profile.h) times the scanning and the output
+ * of this loop, and prints what it counted when pp1 exits.
  */
 int main(int argc, char *argv[])
 {
   TokenType token;
+  TokenWriter writer;
+  TokenCache cache;
+  CacheEntry entry = NULL;
+  SymbolDictionary dict = NULL;
 
   ParseCommandLine(argc, argv);
 
-  Inityylex();
-  while ((token = (TokenType)yylex()) != 0) 
-      PrintOneToken(token, yytext, yylval, yylloc);
+  if (gDictionaryFile) {
+      dict = SymbolDictionaryOpen(gDictionaryFile);
+      SetScannerDictionary(dict);
+  }
+
+  if (gCheckEngines)
+      return CompareEngines(gInputFiles[0]) ? 0 : 1;
+  cache = gCacheDirectory ? TokenCacheNew(gCacheDirectory, 0) : NULL;
+  if (gNumThreads == 0 && gNumInputFiles > 1)
+      gNumThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (gNumInputFiles > 1) {
+      ScanFiles(gInputFiles, gNumInputFiles, gNumThreads > 0 ? gNumThreads : 1, cache);
+      if (cache)
+          TokenCacheFree(cache);
+      return 0;
+  }
+
+  writer = gBinaryOutput ? TokenWriterNew(STDOUT_FILENO, 0) : NULL;
+  if (cache)
+      entry = CacheEntryOpen(cache, gInputFiles[0], true, writer ? TokenWriterAppendError : NULL,
+                             writer);
+
+  if (entry && CacheEntryFound(entry)) {
+      CacheEntryReplay(entry, writer);
+  } else if (gNumThreads > 0) {
+      ScanFileInChunks(gInputFiles[0], gNumThreads, 0, writer);
+  } else {
+      if (gNumInputFiles == 1)
+          Inityylex(gInputFiles[0]);
+      else
+          Inityylex();
+      if (gMemoryBudget > 0)
+          SetyylexMemoryBudget(gMemoryBudget);
+      if (entry)
+          SetErrorHandler(CacheEntryAppendError, entry);
+      else if (writer)
+          SetErrorHandler(TokenWriterAppendError, writer);
+      for (;;) {
+          PROFILE_START(ProfileScan);
+          token = (TokenType)yylex();
+          PROFILE_STOP(ProfileScan);
+          if (token == 0)
+              break;
+          PROFILE_START(ProfileOutput);
+          if (entry)
+              CacheEntryAppend(entry, token, yytext, yyleng, yylval, yylloc);
+          if (writer)
+              TokenWriterAppend(writer, token, yytext, yyleng, yylval, yylloc);
+          else
+              PrintOneToken(token, yytext, yylval, yylloc);
+          PROFILE_STOP(ProfileOutput);
+      }
+      SetErrorHandler(NULL, NULL);
+      if (entry)
+          CacheEntryStore(entry);
+      Finishyylex();
+  }
+
+  if (writer)
+      TokenWriterFree(writer);
+  if (entry)
+      CacheEntryFree(entry);
+  if (cache)
+      TokenCacheFree(cache);
+  if (dict)
+      SymbolDictionaryClose(dict);
   return 0;
 }
 
@@ -73,22 +155,98 @@ int main(int argc, char *argv[])
 /*
  * Function: ParseCommandLine
  * --------------------------
- * Turn on the debugging flags from the command line.  Verifies that
- * first argument is -d, and then interpret all the arguments that follow
- * as being flags to turn on.
+ * Turn on the output options and debugging flags from the command line.
+ * An optional -b selects binary output, an optional -j sets the number
+ * of threads for the parallel drivers, an optional -e picks the scanner
+ * engine (flex, fast, or check to compare them), an optional -c names
+ * a token cache directory, an optional -m sets a memory budget in
+ * kilobytes for streaming, an optional -D names a symbol dictionary,
+ * and optional file names make pp1 scan those
+ * files instead of stdin.  After that, the only argument allowed is
+ * -d, and all the arguments that follow it are interpreted as
+ * debugging flags to turn on.
  */
 static void ParseCommandLine(int argc, char *argv[])
 {
-  int i;
+  int i = 1;
   
-  if (argc == 1) 
+  if (i < argc && strcmp(argv[i], "-b") == 0) {
+    gBinaryOutput = true;
+    i++;
+  }
+
+  if (i + 1 < argc && strcmp(argv[i], "-j") == 0) {
+    gNumThreads = atoi(argv[i + 1]);
+    if (gNumThreads <= 0)
+      Usage();
+    i += 2;
+  }
+
+  if (i + 1 < argc && strcmp(argv[i], "-e") == 0) {
+    gFastEngine = (strcmp(argv[i + 1], "fast") == 0);
+    if (gFastEngine)
+      SetScannerEngine(FastEngine);
+    else if (strcmp(argv[i + 1], "check") == 0)
+      gCheckEngines = true;
+    else if (strcmp(argv[i + 1], "flex") != 0)
+      Usage();
+    i += 2;
+  }
+
+  if (i + 1 < argc && strcmp(argv[i], "-c") == 0) {
+    gCacheDirectory = argv[i + 1];
+    i += 2;
+  }
+
+  if (i + 1 < argc && strcmp(argv[i], "-m") == 0) {
+    gMemoryBudget = atol(argv[i + 1]) * 1024;
+    if (gMemoryBudget <= 0)
+      Usage();
+    i += 2;
+  }
+
+  if (i + 1 < argc && strcmp(argv[i], "-D") == 0) {
+    gDictionaryFile = argv[i + 1];
+    i += 2;
+  }
+
+  gInputFiles = &argv[i];
+  while (i < argc && argv[i][0] != '-') {
+    gNumInputFiles++;
+    i++;
+  }
+
+  // the binary stream is of one file's tokens, not of merged
+  // statistics, and chunks are only cut from a file, not stdin.  The
+  // engines are compared on one file, with nothing else to do.  Only
+  // files can be looked up in the cache, by their contents, before
+  // they are scanned.
+  if ((gBinaryOutput && gNumInputFiles > 1) || (gNumThreads > 0 && gNumInputFiles == 0))
+    Usage();
+  if (gCheckEngines && (gNumInputFiles != 1 || gBinaryOutput || gNumThreads > 0))
+    Usage();
+  if (gCacheDirectory && (gNumInputFiles == 0 || gCheckEngines))
+    Usage();
+  // streaming drops each token's Declaration once the next one is
+  // scanned, which only the one-token-at-a-time loop in main() allows
+  // for, and the fast engine reads all of stdin before it starts
+  if (gMemoryBudget > 0 && (gNumInputFiles > 1 || gNumThreads > 0 || gCheckEngines
+                            || gCacheDirectory || (gFastEngine && gNumInputFiles == 0)))
+    Usage();
+
+  if (i == argc) 
     return;
   
-  if (strcmp(argv[1], "-d") != 0) { // first arg is not -d
-    printf("Usage:   -d <debug-key-1> <debug-key-2> ... \n");
-    exit(2);
-  }
+  if (strcmp(argv[i], "-d") != 0) // remaining args don't start with -d
+    Usage();
 
-  for (i = 2; i < argc; i++) 
+  for (i++; i < argc; i++) 
     DebugOn(argv[i]);
 }
+
+
+static void Usage()
+{
+  printf("Usage:   [-b] [-j <threads>] [-e flex|fast|check] [-c <cache-dir>] [-m <kbytes>] [-D <dictionary>] [file ...] [-d <debug-key-1> <debug-key-2> ...]\n");
+  exit(2);
+}
@@ -0,0 +1,100 @@
+/*
+ * File: numbers.h
+ * ---------------
+ * Conversion of the scanner's numeric literals to their values.  The
+ * scanner already knows where each literal ends and that it is well
+ * formed, so these take the lexeme and its length and do no more than
+ * convert: no locale, no skipping of blanks or signs, no looking for
+ * the end again as atol(), strtol() and atof() do.
+ *
+ * Decaf's ints are 32 bits.  A decimal literal is out of range past
+ * INT_MAX; a hex one is taken as a 32-bit pattern, as strtol() and a
+ * cast made it before, so 0xFFFFFFFF is -1, and it is out of range past
+ * eight significant digits.  A double is out of range if it rounds to
+ * infinity.  Each converter returns false for a literal out of range,
+ * and the scanner reports it with ReportError().
+ */
+
+#ifndef _H_numbers
+#define _H_numbers
+
+#include <limits.h>
+#include <stdint.h>
+
+/*
+ * Function: ParseDecimalInt()
+ * Usage: if (!ParseDecimalInt(yytext, yyleng, &value)) ...
+ * --------------------------------------------------------
+ * Converts the length digits at text, a {DECIMALINT}, to *value.  Out
+ * of range, *value is INT_MAX and the result false.
+ */
+static inline bool ParseDecimalInt(const char *text, int length, int *value)
+{
+    uint64_t    n = 0;
+    int         i;
+
+    // ten digits can't overflow 64 bits, and any more than that
+    // (past leading zeros) are out of range anyway
+    for (i = 0; i < length; i++) {
+        n = n * 10 + (text[i] - '0');
+        if (n > INT_MAX) {
+            *value = INT_MAX;
+            return false;
+        }
+    }
+    *value = (int) n;
+    return true;
+}
+
+/*
+ * Function: ParseHexInt()
+ * Usage: if (!ParseHexInt(yytext, yyleng, &value)) ...
+ * ----------------------------------------------------
+ * Converts the length characters at text, a {HEXINT} with its 0x, to
+ * *value.  Out of range, *value is -1 (all 32 bits set) and the result
+ * false.
+ */
+static inline bool ParseHexInt(const char *text, int length, int *value)
+{
+    uint64_t    n = 0;
+    int         i, c;
+
+    for (i = 2; i < length; i++) {
+        c = text[i];
+        // '0'-'9' are 0x30-0x39, 'A'-'F' 0x41-0x46 and 'a'-'f' 0x61-0x66
+        n = (n << 4) | ((c & 0xf) + (c >> 6) * 9);
+        if (n > UINT32_MAX) {
+            *value = -1;
+            return false;
+        }
+    }
+    *value = (int)(uint32_t) n;
+    return true;
+}
+
+/*
+ * Function: ParseDouble()
+ * Usage: if (!ParseDouble(yytext, yyleng, &value)) ...
+ * ----------------------------------------------------
+ * Converts the length characters at text, a {DOUBLECONSTANT}, to the
+ * nearest double, rounding exactly as strtod() does.  Out of range,
+ * *value is infinity and the result false.
+ */
+bool ParseDouble(const char *text, int length, double *value);
+
+/*
+ * Function: QuotedLength()
+ * Usage: ReportError(&yylloc, "...: %.*s", QuotedLength(yyleng), yytext);
+ * ------------------------------------------------------------------------
+ * Returns how much of a literal length characters long an error about
+ * it quotes.  A literal can run to any number of digits, and the error
+ * shows no more than its first MaxQuotedLiteral.
+ */
+#define MaxQuotedLiteral 64
+
+static inline int QuotedLength(int length)
+{
+    return length < MaxQuotedLiteral ? length : MaxQuotedLiteral;
+}
+
+#endif
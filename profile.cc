@@ -0,0 +1,143 @@
+/* File: profile.cc
+ * ----------------
+ * Implementation of the scanner instrumentation.  See profile.h for
+ * comments.  Without PP1_PROFILE there is nothing here.
+ *
+ * Each thread counts into its own ProfileCounters, whose destructor
+ * adds them to gTotals when the thread exits.  The main thread's run
+ * as exit() starts, before the atexit() handler that prints the
+ * report, so by then every thread's counts are in.
+ */
+
+#ifdef PP1_PROFILE
+
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "profile.h"
+
+thread_local ProfileCounters gProfile;
+
+static ProfileCounters *gTotals;
+static std::mutex gTotalsLock;
+static const char **gRuleNames;
+static int gNumRuleNames;
+
+static const char *gCounterNames[ProfileNumCounters] = {
+    "symbol hits", "symbol misses", "symbol spill hits", "dictionary hits",
+    "string hits", "string misses",
+    "arena allocations", "arena bytes", "arena blocks"
+};
+
+static const char *gTimerNames[ProfileNumTimers] = { "scanning", "output" };
+
+static const char *gProbeBuckets[PROFILE_PROBE_BUCKETS] = {
+    "1", "2", "3", "4", "5-8", "9-16", "17-32", ">32"
+};
+
+
+long ProfileClock()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000L + now.tv_nsec;
+}
+
+
+void ProfileNameRules(const char **names, int numNames)
+{
+    gRuleNames = names;
+    gNumRuleNames = numNames;
+}
+
+
+ProfileCounters::~ProfileCounters()
+{
+    long    *from = (long *) this, *to;
+    size_t  i;
+
+    // every field is a long, and they all add up
+    std::lock_guard<std::mutex> hold(gTotalsLock);
+    if (gTotals == NULL)
+        return;
+    to = (long *) gTotals;
+    for (i = 0; i < sizeof(ProfileCounters) / sizeof(long); i++)
+        to[i] += from[i];
+}
+
+
+static double Percent(long part, long whole)
+{
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+
+static void ProfileReport()
+{
+    ProfileCounters *t = gTotals;
+    long            matches = 0, tokens = 0, timed = 0, lookups;
+    int             i;
+
+    for (i = 0; i < PROFILE_MAX_RULES; i++)
+        matches += t->ruleMatches[i];
+    for (i = 0; i < PROFILE_TOKEN_KINDS; i++)
+        tokens += t->tokens[i];
+    for (i = 0; i < ProfileNumTimers; i++)
+        timed += t->nanoseconds[i];
+    lookups = t->counts[ProfileSymbolHits] + t->counts[ProfileSymbolMisses];
+
+    fprintf(stderr, "\n*** Profile\n");
+    if (matches > 0) {
+        fprintf(stderr, "%-24s %12s %7s %14s\n", "flex rule", "matches", "%", "bytes");
+        for (i = 0; i < PROFILE_MAX_RULES; i++) {
+            if (t->ruleMatches[i] == 0)
+                continue;
+            if (i < gNumRuleNames && gRuleNames[i] != NULL)
+                fprintf(stderr, "%-24s", gRuleNames[i]);
+            else
+                fprintf(stderr, "rule %-19d", i);
+            fprintf(stderr, " %12ld %6.2f%% %14ld\n", t->ruleMatches[i],
+                    Percent(t->ruleMatches[i], matches), t->ruleBytes[i]);
+        }
+    }
+    if (tokens > 0) {
+        fprintf(stderr, "%-24s %12s %7s %14s\n", "token type", "tokens", "%", "bytes");
+        for (i = 0; i < PROFILE_TOKEN_KINDS; i++)
+            if (t->tokens[i] > 0)
+                fprintf(stderr, "%-24s %12ld %6.2f%% %14ld\n",
+                        i == 0 ? "single char" : gTokenNames[i - 1], t->tokens[i],
+                        Percent(t->tokens[i], tokens), t->tokenBytes[i]);
+    }
+    for (i = 0; i < ProfileNumCounters; i++)
+        fprintf(stderr, "%-24s %12ld\n", gCounterNames[i], t->counts[i]);
+    if (lookups > 0) {
+        fprintf(stderr, "%-24s %12.2f%%\n", "symbol hit rate",
+                Percent(t->counts[ProfileSymbolHits], lookups));
+        fprintf(stderr, "%-24s %12.2f\n", "probes per lookup", (double) t->totalProbes / lookups);
+        for (i = 0; i < PROFILE_PROBE_BUCKETS; i++)
+            if (t->probes[i] > 0)
+                fprintf(stderr, "  %-5s probes %15ld %6.2f%%\n", gProbeBuckets[i], t->probes[i],
+                        Percent(t->probes[i], lookups));
+    }
+    for (i = 0; i < ProfileNumTimers; i++)
+        fprintf(stderr, "%-24s %12.3f ms %6.2f%%\n", gTimerNames[i], t->nanoseconds[i] / 1e6,
+                Percent(t->nanoseconds[i], timed));
+}
+
+
+/*
+ * The totals are set up, and the report registered, before main()
+ * runs.  They are never freed, so a thread exiting after the report
+ * is still safe.
+ */
+static struct ProfileSetup {
+    ProfileSetup()
+    {
+        gTotals = new ProfileCounters();
+        atexit(ProfileReport);
+    }
+} gProfileSetup;
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * File: profile.h
+ * ---------------
+ * Built-in instrumentation of the scanner's hot paths, for seeing
+ * where the time goes on real inputs without a profiler.  It counts
+ * the matches and bytes of each flex rule, the tokens and bytes of
+ * each token type, symbol table and string pool hits, misses and probe
+ * lengths, and arena allocations, and times scanning against output.
+ * A summary is printed to stderr when pp1 exits.
+ *
+ * All of it is compiled in only when PP1_PROFILE is defined, as with
+ *
+ *     make WITH_PROFILE=-DPP1_PROFILE
+ *
+ * Otherwise every macro below expands to nothing, arguments and all.
+ * Counters are kept per thread, with no locks or atomics on the hot
+ * paths, and added to the totals as each thread exits.
+ */
+
+#ifndef _H_profile
+#define _H_profile
+
+#include "scanner.h"
+
+typedef enum {
+    ProfileSymbolHits,          // identifiers already in the table
+    ProfileSymbolMisses,        // identifiers new to the table
+    ProfileSpillHits,           // ... of which were brought back from a spill
+    ProfileDictionaryHits,      // identifiers found in the symbol dictionary
+    ProfileStringHits,          // string constants already in the pool
+    ProfileStringMisses,
+    ProfileArenaAllocs,
+    ProfileArenaBytes,
+    ProfileArenaBlocks,         // blocks malloc'd by arenas
+    ProfileNumCounters
+} ProfileCounter;
+
+typedef enum {
+    ProfileScan,                // getting tokens from the scanner
+    ProfileOutput,              // printing or writing them
+    ProfileNumTimers
+} ProfileTimer;
+
+#ifdef PP1_PROFILE
+
+#define PROFILE_MAX_RULES       64
+#define PROFILE_PROBE_BUCKETS   8       // 1, 2, 3, 4, 5-8, 9-16, 17-32, more
+#define PROFILE_TOKEN_KINDS     (T_NumTokenTypes - 256 + 1) // [0] is every single char
+
+struct ProfileCounters {
+    long        counts[ProfileNumCounters];
+    long        probes[PROFILE_PROBE_BUCKETS];
+    long        totalProbes;
+    long        ruleMatches[PROFILE_MAX_RULES], ruleBytes[PROFILE_MAX_RULES];
+    long        tokens[PROFILE_TOKEN_KINDS], tokenBytes[PROFILE_TOKEN_KINDS];
+    long        nanoseconds[ProfileNumTimers];
+    long        started[ProfileNumTimers];
+
+    ~ProfileCounters();         // adds this thread's counts to the totals
+};
+
+extern thread_local ProfileCounters gProfile;
+
+long ProfileClock();
+void ProfileNameRules(const char **names, int numNames);
+
+static inline void ProfileCount(ProfileCounter counter, long n)
+{
+    gProfile.counts[counter] += n;
+}
+
+static inline void ProfileProbes(int n)
+{
+    int     bucket = (n <= 4 ? n - 1 : n <= 8 ? 4 : n <= 16 ? 5 : n <= 32 ? 6 : 7);
+
+    gProfile.probes[bucket]++;
+    gProfile.totalProbes += n;
+}
+
+static inline void ProfileRule(int rule, int length)
+{
+    if (rule >= 0 && rule < PROFILE_MAX_RULES) {
+        gProfile.ruleMatches[rule]++;
+        gProfile.ruleBytes[rule] += length;
+    }
+}
+
+static inline void ProfileToken(int type, int length)
+{
+    int     kind = (type >= 256 && type < T_NumTokenTypes ? type - 256 + 1 : 0);
+
+    if (type == 0)              // the end of the input
+        return;
+    gProfile.tokens[kind]++;
+    gProfile.tokenBytes[kind] += length;
+}
+
+#define PROFILE_COUNT(counter, n)       ProfileCount(counter, n)
+#define PROFILE_PROBES(n)               ProfileProbes(n)
+#define PROFILE_RULE(rule, length)      ProfileRule(rule, length)
+#define PROFILE_RULE_NAMES(names, n)    ProfileNameRules(names, n)
+#define PROFILE_TOKEN(type, length)     ProfileToken(type, length)
+#define PROFILE_START(timer)            (gProfile.started[timer] = ProfileClock())
+#define PROFILE_STOP(timer)             (gProfile.nanoseconds[timer] += ProfileClock() - gProfile.started[timer])
+
+#else
+
+#define PROFILE_COUNT(counter, n)       ((void)0)
+#define PROFILE_PROBES(n)               ((void)0)
+#define PROFILE_RULE(rule, length)      ((void)0)
+#define PROFILE_RULE_NAMES(names, n)    ((void)0)
+#define PROFILE_TOKEN(type, length)     ((void)0)
+#define PROFILE_START(timer)            ((void)0)
+#define PROFILE_STOP(timer)             ((void)0)
+
+#endif
+
+#endif
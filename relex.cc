@@ -0,0 +1,482 @@
+/* File: relex.cc
+ * --------------
+ * Implementation of incremental scanning.  See relex.h for comments.
+ *
+ * Each line is scanned on its own, by one Scanner that is pointed at
+ * line after line with ScannerSetText().  That scanner interns
+ * identifiers in a table of its own, which only grows; the counts that
+ * matter are kept in the Relexer's table, where the identifiers of each
+ * line are entered once the edit that produced the line is known to be
+ * complete.
+ */
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "relex.h"
+#include "symtab.h"
+#include "declaration.h"
+#include "utility.h"
+
+#define SYMBOLS_SIZE_HINT   1024
+#define NOT_SEEN            INT_MAX     // first line of an identifier whose
+                                        // first occurrence was edited away
+
+
+typedef struct {
+    char        *text;          // the line, with its '\n' unless it is the last
+    int         length;
+    int         startDepth;     // comment depth at the start of the line
+    LineToken   *tokens;
+    int         numTokens;
+} Line;
+
+struct RelexerImplementation {
+    Line            *lines;
+    int             numLines, maxLines;
+    Scanner         scanner;        // scans one line at a time
+    SymbolTable     *symbols;       // identifiers of the whole buffer
+    LineToken       *scratch;       // tokens of the line being scanned
+    int             numScratch, maxScratch;
+    Declaration     **lost;         // identifiers whose first line an edit
+    int             numLost, maxLost; // took away
+};
+
+
+static LineToken *NewScratchToken(Relexer relexer)
+{
+    if (relexer->numScratch == relexer->maxScratch) {
+        relexer->maxScratch = (relexer->maxScratch ? 2 * relexer->maxScratch : 64);
+        relexer->scratch = (LineToken *) realloc(relexer->scratch,
+                                                 relexer->maxScratch * sizeof(LineToken));
+        Assert(relexer->scratch != NULL);
+    }
+    return &relexer->scratch[relexer->numScratch++];
+}
+
+
+/* The error handler while a line is being scanned */
+static void CollectLineError(struct yyltype *pos, const char *message, void *clientData)
+{
+    LineToken   *token = NewScratchToken((Relexer) clientData);
+    int         length = strlen(message);
+
+    token->type = TOKEN_ERROR;
+    token->firstColumn = pos ? pos->first_column : 0;
+    token->lastColumn = pos ? pos->last_column : 0;
+    token->message = (char *) malloc(length + 1);
+    Assert(token->message != NULL);
+    memcpy(token->message, message, length + 1);
+}
+
+
+/*
+ * Function: ScanLine()
+ * --------------------
+ * Scans the line, starting commentDepth deep in comments, and gives it
+ * the tokens found.  Identifiers are left without a Declaration; see
+ * AddIdentifiers().  Returns the comment depth at the end of the line.
+ */
+static int ScanLine(Relexer relexer, Line *line, int commentDepth, bool isLast)
+{
+    LineToken       *token;
+    struct yyltype  loc;
+    int             type;
+
+    line->startDepth = commentDepth;
+    ScannerSetText(relexer->scanner, line->text, line->length, commentDepth, !isLast);
+    relexer->numScratch = 0;
+
+    SetErrorHandler(CollectLineError, relexer);
+    while ((type = ScannerNextToken(relexer->scanner)) != 0) {
+        loc = ScannerLocation(relexer->scanner);
+        token = NewScratchToken(relexer);
+        token->type = type;
+        token->firstColumn = loc.first_column;
+        token->lastColumn = loc.last_column;
+        token->value = ScannerValue(relexer->scanner);
+        token->message = NULL;
+        if (type == T_Identifier)
+            token->value.decl = NULL;
+    }
+    SetErrorHandler(NULL, NULL);
+
+    line->numTokens = relexer->numScratch;
+    line->tokens = NULL;
+    if (line->numTokens > 0) {
+        line->tokens = (LineToken *) malloc(line->numTokens * sizeof(LineToken));
+        Assert(line->tokens != NULL);
+        memcpy(line->tokens, relexer->scratch, line->numTokens * sizeof(LineToken));
+    }
+    return ScannerCommentDepth(relexer->scanner);
+}
+
+
+/* Makes a line of a copy of the length characters at text */
+static Line NewLine(const char *text, int length)
+{
+    Line    line;
+
+    line.text = (char *) malloc(length > 0 ? length : 1);
+    Assert(line.text != NULL);
+    memcpy(line.text, text, length);
+    line.length = length;
+    line.startDepth = 0;
+    line.tokens = NULL;
+    line.numTokens = 0;
+    return line;
+}
+
+
+static void FreeLineTokens(Line *line)
+{
+    int     i;
+
+    for (i = 0; i < line->numTokens; i++)
+        free(line->tokens[i].message);
+    free(line->tokens);
+}
+
+
+/*
+ * Function: AddIdentifiers()
+ * --------------------------
+ * Counts the identifiers of the line, which is line number lineNum,
+ * into the symbol table and points its tokens at their Declarations.
+ */
+static void AddIdentifiers(Relexer relexer, Line *line, int lineNum)
+{
+    LineToken   *token;
+    Declaration *decl;
+    int         i;
+
+    for (i = 0; i < line->numTokens; i++) {
+        token = &line->tokens[i];
+        if (token->type != T_Identifier)
+            continue;
+        decl = relexer->symbols->Intern(line->text + token->firstColumn - 1,
+                                        token->lastColumn - token->firstColumn + 1, lineNum);
+        // a name seen again after all its occurrences were edited
+        // away starts over
+        if (decl->GetOccurrences() == 1 || decl->GetFirstLine() > lineNum)
+            decl->SetFirstLine(lineNum);
+        token->value.decl = decl;
+    }
+}
+
+
+/*
+ * Function: RemoveIdentifiers()
+ * -----------------------------
+ * Counts the identifiers of lines first to last (numbered as they were
+ * before the edit) out of the symbol table.  An identifier first seen
+ * in those lines gets a first line of NOT_SEEN, to be worked out again
+ * once the edited lines are back in; see FindLostFirstLines().
+ */
+static void RemoveIdentifiers(Relexer relexer, int first, int last)
+{
+    LineToken   *token;
+    Declaration *decl;
+    Line        *line;
+    int         i, n;
+
+    for (n = first; n <= last; n++) {
+        line = &relexer->lines[n - 1];
+        for (i = 0; i < line->numTokens; i++) {
+            token = &line->tokens[i];
+            if (token->type != T_Identifier)
+                continue;
+            decl = token->value.decl;
+            decl->DecrementOccurrences();
+            if (decl->GetFirstLine() < first || decl->GetFirstLine() > last)
+                continue;
+            decl->SetFirstLine(NOT_SEEN);
+            if (relexer->numLost == relexer->maxLost) {
+                relexer->maxLost = (relexer->maxLost ? 2 * relexer->maxLost : 16);
+                relexer->lost = (Declaration **) realloc(relexer->lost,
+                                                         relexer->maxLost * sizeof(Declaration *));
+                Assert(relexer->lost != NULL);
+            }
+            relexer->lost[relexer->numLost++] = decl;
+        }
+    }
+}
+
+
+typedef struct {
+    int     after;          // lines after this one moved
+    int     delta;          // by this many
+} LineShift;
+
+static void ShiftFirstLine(Declaration *decl, void *clientData)
+{
+    LineShift   *shift = (LineShift *) clientData;
+
+    if (decl->GetFirstLine() > shift->after && decl->GetFirstLine() != NOT_SEEN)
+        decl->SetFirstLine(decl->GetFirstLine() + shift->delta);
+}
+
+
+/*
+ * Function: FindLostFirstLines()
+ * ------------------------------
+ * Gives each identifier whose first occurrence was edited away, and
+ * which didn't turn up again in the edited lines, its new first line.
+ * There were no occurrences before the edited lines, so the search
+ * starts at fromLine, just after them.
+ */
+static void FindLostFirstLines(Relexer relexer, int fromLine)
+{
+    Declaration *decl;
+    Line        *line;
+    int         i, j, n;
+
+    for (i = 0; i < relexer->numLost; i++) {
+        decl = relexer->lost[i];
+        if (decl->GetFirstLine() != NOT_SEEN)
+            continue;
+        if (decl->GetOccurrences() == 0) {
+            decl->SetFirstLine(0);
+            continue;
+        }
+        for (n = fromLine; n <= relexer->numLines && decl->GetFirstLine() == NOT_SEEN; n++) {
+            line = &relexer->lines[n - 1];
+            for (j = 0; j < line->numTokens; j++)
+                if (line->tokens[j].type == T_Identifier && line->tokens[j].value.decl == decl) {
+                    decl->SetFirstLine(n);
+                    break;
+                }
+        }
+        Assert(decl->GetFirstLine() != NOT_SEEN);
+    }
+    relexer->numLost = 0;
+}
+
+
+static void ReserveLines(Relexer relexer, int numLines)
+{
+    if (numLines > relexer->maxLines) {
+        relexer->maxLines = (2 * relexer->maxLines > numLines ? 2 * relexer->maxLines : numLines);
+        relexer->lines = (Line *) realloc(relexer->lines, relexer->maxLines * sizeof(Line));
+        Assert(relexer->lines != NULL);
+    }
+}
+
+
+Relexer RelexerNew(const char *text, long length)
+{
+    Relexer     relexer;
+    const char  *p, *end = text + length, *newline;
+    int         depth, i;
+
+    Assert(text != NULL || length == 0);
+
+    relexer = (Relexer) malloc(sizeof(struct RelexerImplementation));
+    Assert(relexer != NULL);
+    memset(relexer, 0, sizeof(struct RelexerImplementation));
+    relexer->scanner = ScannerNewText("", 0, 0, false, NULL);
+    relexer->symbols = new SymbolTable(SYMBOLS_SIZE_HINT);
+
+    // split into lines, the last one without a newline
+    for (p = text; ; p = newline + 1) {
+        newline = (const char *) memchr(p, '\n', end - p);
+        ReserveLines(relexer, relexer->numLines + 1);
+        relexer->lines[relexer->numLines++] = NewLine(p, (newline ? newline + 1 : end) - p);
+        if (newline == NULL)
+            break;
+    }
+
+    for (i = 0, depth = 0; i < relexer->numLines; i++) {
+        depth = ScanLine(relexer, &relexer->lines[i], depth, i == relexer->numLines - 1);
+        AddIdentifiers(relexer, &relexer->lines[i], i + 1);
+    }
+    return relexer;
+}
+
+
+int RelexerEdit(Relexer relexer, int firstLine, int firstOffset,
+                int lastLine, int lastOffset, const char *text, long length)
+{
+    Line        *first, *last, *fresh;
+    char        *joined;
+    const char  *p, *end, *newline;
+    long        joinedLength;
+    int         numFresh, maxFresh, next, depth, i;
+    bool        endsBuffer;
+    LineShift   shift;
+
+    Assert(firstLine >= 1 && firstLine <= lastLine && lastLine <= relexer->numLines);
+    Assert(text != NULL || length == 0);
+
+    // an edit reaching past a newline ends at the start of the next line
+    if (lastLine < relexer->numLines && lastOffset == relexer->lines[lastLine - 1].length) {
+        lastLine++;
+        lastOffset = 0;
+    }
+    first = &relexer->lines[firstLine - 1];
+    last = &relexer->lines[lastLine - 1];
+    Assert(firstOffset >= 0 && firstOffset <= first->length);
+    Assert(lastOffset >= 0 && lastOffset <= last->length);
+    Assert(firstLine < lastLine || firstOffset <= lastOffset);
+
+    // the edited lines' new text: what is left of the first line, the
+    // new text, and what is left of the last line
+    joinedLength = firstOffset + length + (last->length - lastOffset);
+    joined = (char *) malloc(joinedLength > 0 ? joinedLength : 1);
+    Assert(joined != NULL);
+    memcpy(joined, first->text, firstOffset);
+    memcpy(joined + firstOffset, text, length);
+    memcpy(joined + firstOffset + length, last->text + lastOffset, last->length - lastOffset);
+
+    // scan its lines, and then the lines after it for as long as they
+    // start at a different depth than before.  Unless the edit runs to
+    // the end of the buffer, the new text ends with a newline, and
+    // there is no partial line after it.
+    maxFresh = 16;
+    fresh = (Line *) malloc(maxFresh * sizeof(Line));
+    Assert(fresh != NULL);
+    numFresh = 0;
+    depth = first->startDepth;
+    endsBuffer = (lastLine == relexer->numLines);
+    for (p = joined, end = joined + joinedLength; ; p = newline + 1) {
+        newline = (const char *) memchr(p, '\n', end - p);
+        if (newline == NULL && !endsBuffer)
+            break;
+        if (numFresh == maxFresh) {
+            maxFresh *= 2;
+            fresh = (Line *) realloc(fresh, maxFresh * sizeof(Line));
+            Assert(fresh != NULL);
+        }
+        fresh[numFresh] = NewLine(p, (newline ? newline + 1 : end) - p);
+        depth = ScanLine(relexer, &fresh[numFresh], depth, newline == NULL);
+        numFresh++;
+        if (newline == NULL)
+            break;
+    }
+    free(joined);
+
+    for (next = lastLine; next < relexer->numLines && relexer->lines[next].startDepth != depth; next++) {
+        if (numFresh == maxFresh) {
+            maxFresh *= 2;
+            fresh = (Line *) realloc(fresh, maxFresh * sizeof(Line));
+            Assert(fresh != NULL);
+        }
+        // the text is unchanged, so it moves over rather than being copied
+        fresh[numFresh] = relexer->lines[next];
+        relexer->lines[next].text = NULL;
+        depth = ScanLine(relexer, &fresh[numFresh], depth, next == relexer->numLines - 1);
+        numFresh++;
+    }
+
+    // lines firstLine to next (as numbered before the edit) are
+    // replaced by the fresh ones
+    RemoveIdentifiers(relexer, firstLine, next);
+    for (i = firstLine - 1; i < next; i++) {
+        FreeLineTokens(&relexer->lines[i]);
+        free(relexer->lines[i].text);
+    }
+    shift.after = next;
+    shift.delta = numFresh - (next - firstLine + 1);
+    ReserveLines(relexer, relexer->numLines + shift.delta);
+    memmove(&relexer->lines[firstLine - 1 + numFresh], &relexer->lines[next],
+            (relexer->numLines - next) * sizeof(Line));
+    memcpy(&relexer->lines[firstLine - 1], fresh, numFresh * sizeof(Line));
+    relexer->numLines += shift.delta;
+    free(fresh);
+
+    if (shift.delta != 0)
+        relexer->symbols->Map(ShiftFirstLine, &shift);
+    for (i = 0; i < numFresh; i++)
+        AddIdentifiers(relexer, &relexer->lines[firstLine - 1 + i], firstLine + i);
+    FindLostFirstLines(relexer, firstLine + numFresh);
+    return numFresh;
+}
+
+
+int RelexerNumLines(Relexer relexer)
+{
+    return relexer->numLines;
+}
+
+
+const char *RelexerLineText(Relexer relexer, int line, int *length)
+{
+    Assert(line >= 1 && line <= relexer->numLines);
+    *length = relexer->lines[line - 1].length;
+    return relexer->lines[line - 1].text;
+}
+
+
+int RelexerLineTokens(Relexer relexer, int line, const LineToken **tokens)
+{
+    Assert(line >= 1 && line <= relexer->numLines);
+    *tokens = relexer->lines[line - 1].tokens;
+    return relexer->lines[line - 1].numTokens;
+}
+
+
+SymbolTable *RelexerSymbols(Relexer relexer)
+{
+    return relexer->symbols;
+}
+
+
+void RelexerPrint(Relexer relexer)
+{
+    SymbolTable     *counts = new SymbolTable(SYMBOLS_SIZE_HINT);
+    LineToken       *token;
+    Line            *line;
+    struct yyltype  loc;
+    YYSTYPE         value;
+    char            *text = NULL;
+    int             i, j, length, maxLength = 0;
+
+    // pp1 prints each identifier's count as of the token, so the
+    // counts are taken again as the tokens go by
+    for (i = 0; i < relexer->numLines; i++) {
+        line = &relexer->lines[i];
+        loc.first_line = i + 1;
+        for (j = 0; j < line->numTokens; j++) {
+            token = &line->tokens[j];
+            loc.first_column = token->firstColumn;
+            loc.last_column = token->lastColumn;
+            if (token->type == TOKEN_ERROR) {
+                PrintError(&loc, token->message);
+                continue;
+            }
+
+            length = token->lastColumn - token->firstColumn + 1;
+            if (length + 1 > maxLength) {
+                maxLength = 2 * (length + 1);
+                text = (char *) realloc(text, maxLength);
+                Assert(text != NULL);
+            }
+            memcpy(text, line->text + token->firstColumn - 1, length);
+            text[length] = '\0';
+
+            value = token->value;
+            if (token->type == T_Identifier)
+                value.decl = counts->Intern(text, length, i + 1);
+            PrintOneToken((TokenType) token->type, text, value, loc);
+        }
+    }
+    free(text);
+    delete counts;
+}
+
+
+void RelexerFree(Relexer relexer)
+{
+    int     i;
+
+    for (i = 0; i < relexer->numLines; i++) {
+        FreeLineTokens(&relexer->lines[i]);
+        free(relexer->lines[i].text);
+    }
+    free(relexer->lines);
+    free(relexer->scratch);
+    free(relexer->lost);
+    delete relexer->symbols;
+    ScannerFree(relexer->scanner);
+    free(relexer);
+}
@@ -0,0 +1,126 @@
+/*
+ * File: relex.h
+ * -------------
+ * Incremental scanning of a buffer that is being edited, for editor
+ * integration.  A Relexer keeps a buffer's text and tokens line by
+ * line, along with the comment depth each line starts at: 0 if the
+ * scanner is in INITIAL there, how deeply nested it is if it is in
+ * COMMENT.  No token spans lines, so a line's tokens depend only on
+ * its text and that depth.
+ *
+ * An edit scans the lines it touches again, and then goes on to the
+ * following lines only while the depth at the start of each differs
+ * from what it was before the edit.  As soon as the two agree, every
+ * line from there on would scan exactly as it did before, so it is
+ * left alone.  A one-character edit usually rescans a single line, no
+ * matter how big the buffer is; one that opens or closes a comment
+ * rescans as far as the comment reaches.
+ *
+ * The Relexer's symbol table is kept up to date the same way: the
+ * identifiers of the lines replaced are counted out of it and those
+ * of their replacements counted in, rather than the table being
+ * rebuilt.  An identifier that no longer occurs keeps its Declaration,
+ * with no occurrences and a first line of 0.
+ *
+ * Lines are numbered from 1, like yylloc.  Every line but the last
+ * ends with its '\n'; the last has none, and is empty if the buffer
+ * ends with a newline.
+ */
+
+#ifndef _H_relex
+#define _H_relex
+
+#include "scanner.h"
+#include "tokenstream.h"
+
+class SymbolTable;
+
+/*
+ * Type: LineToken
+ * ---------------
+ * A token, or an error reported while scanning, on one line.  Its text
+ * is the part of the line between its columns; an error's is message.
+ */
+typedef struct {
+    int         type;               // TokenType or char, or TOKEN_ERROR
+    int         firstColumn, lastColumn;
+    YYSTYPE     value;              // T_Identifier's decl is in the
+                                    // Relexer's symbol table
+    char        *message;           // TOKEN_ERROR's message, else NULL
+} LineToken;
+
+
+typedef struct RelexerImplementation *Relexer;
+
+/*
+ * Function: RelexerNew()
+ * Usage: relexer = RelexerNew(text, length);
+ * ------------------------------------------
+ * Makes a Relexer for a buffer holding the length characters at text,
+ * and scans all of it.
+ */
+Relexer RelexerNew(const char *text, long length);
+
+/*
+ * Function: RelexerEdit()
+ * Usage: RelexerEdit(relexer, 12, 4, 12, 5, "x", 1);
+ * --------------------------------------------------
+ * Replaces the text from byte offset firstOffset of line firstLine up
+ * to byte offset lastOffset of line lastLine with the length
+ * characters at text, which may contain newlines, and rescans what it
+ * has to.  Offsets count from 0 at the start of the line, and
+ * lastOffset may be the line's length (i.e. take its newline too).
+ * Returns the number of lines that were scanned.
+ */
+int RelexerEdit(Relexer relexer, int firstLine, int firstOffset,
+                int lastLine, int lastOffset, const char *text, long length);
+
+/*
+ * Function: RelexerNumLines()
+ * ---------------------------
+ * Returns the number of lines in the buffer, always at least 1.
+ */
+int RelexerNumLines(Relexer relexer);
+
+/*
+ * Function: RelexerLineText()
+ * ---------------------------
+ * Returns the text of the given line, which is not null-terminated,
+ * and sets length to its length.  It stays valid until the next edit.
+ */
+const char *RelexerLineText(Relexer relexer, int line, int *length);
+
+/*
+ * Function: RelexerLineTokens()
+ * Usage: n = RelexerLineTokens(relexer, line, &tokens);
+ * -----------------------------------------------------
+ * Points tokens at the tokens and errors of the given line, in the
+ * order they were scanned, and returns how many there are.  They stay
+ * valid until the next edit.
+ */
+int RelexerLineTokens(Relexer relexer, int line, const LineToken **tokens);
+
+/*
+ * Function: RelexerSymbols()
+ * --------------------------
+ * Returns the table of every identifier in the buffer, with its
+ * current count and first line.  It belongs to the Relexer.
+ */
+SymbolTable *RelexerSymbols(Relexer relexer);
+
+/*
+ * Function: RelexerPrint()
+ * ------------------------
+ * Prints the buffer's tokens and errors exactly as pp1 would print
+ * them if it scanned the buffer.
+ */
+void RelexerPrint(Relexer relexer);
+
+/*
+ * Function: RelexerFree()
+ * -----------------------
+ * Frees the Relexer, its lines, and its symbol table.
+ */
+void RelexerFree(Relexer relexer);
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * File: scanimpl.h
+ * ----------------
+ * The insides of a Scanner, shared by the two engines that can drive
+ * one: the flex-generated scanner in scanner.l and the hand-written
+ * one in fastscan.cc.  Nothing but those two should include this.
+ */
+
+#ifndef _H_scanimpl
+#define _H_scanimpl
+
+#include <stddef.h>
+#include "scanner.h"
+#include "arena.h"
+#include "spill.h"
+
+class StringPool;
+
+/* the same guarded typedefs flex's own output starts with */
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void *yyscan_t;
+#endif
+
+#ifndef YY_TYPEDEF_YY_BUFFER_STATE
+#define YY_TYPEDEF_YY_BUFFER_STATE
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+#endif
+
+/*
+ * Constant: SCAN_PADDING
+ * ----------------------
+ * How many readable bytes there are past the end of a Scanner's input,
+ * so that the fast engine can load whole vectors near the end without
+ * checking for the last page.  Only the two right after the end are
+ * guaranteed to be '\0'.
+ */
+#define SCAN_PADDING 64
+
+
+/*
+ * Type: ScannerImplementation
+ * ---------------------------
+ * Everything one scanner instance works with.  This is the state that
+ * used to be kept in globals; now each Scanner has its own, so several
+ * can run at once on different threads.  flex hands it to every action
+ * as yyextra.
+ */
+struct ScannerImplementation {
+    ScannerEngine   engine;         // which engine scans the input
+    yyscan_t        flex;           // flex's own per-instance state
+    YYSTYPE         value;          // attributes of the token just scanned
+    struct yyltype  loc;            // position of the token just scanned
+    int             commentDepth;   // depth of comment nesting
+    SymbolTable     *symbols;       // identifiers seen so far
+    StringPool      *strings;       // string constants seen so far
+    Arena           arena;          // storage for all of the above
+    bool            ownsArena;      // true if we made arena ourselves
+    char            *mappedInput;   // input file mapping, or NULL
+    size_t          mappedSize;     // length of mappedInput
+    YY_BUFFER_STATE inputBuffer;    // flex buffer over input, or NULL if
+                                    // flex reads stdin itself
+    bool            endsMidFile;    // input is a chunk short of the file's end
+
+    /* the input as a whole, for the fast engine: it runs from input up
+     * to inputEnd, where two '\0's and then padding follow */
+    char            *input, *inputEnd;
+    char            *ownedInput;    // stdin read in by the fast engine,
+                                    // or a copy of text being scanned
+    size_t          ownedSize;      // allocated length of ownedInput
+    bool            stableInput;    // lexemes stay where they are until
+                                    // ScannerFree()
+
+    /* the fast engine's place in the input.  Like flex, it overwrites
+     * the byte after each lexeme with '\0' while the lexeme is current,
+     * and puts it back when scanning goes on */
+    char            *cursor;        // where the next token starts
+    char            *text;          // the lexeme just scanned
+    int             textLength;
+    char            *holdAt;        // byte overwritten, or NULL
+    char            holdChar;       // what it was
+
+    /* streaming in bounded memory, see ScannerSetMemoryBudget() */
+    long            memoryBudget;   // arena bytes to reclaim past, or 0
+    long            tableBytes;     // arena bytes of the empty tables
+    SymbolSpill     spill;          // where reclaimed names went, or NULL
+    int             numReclaims;
+
+    /* counts used for the "mem" debug report in ScannerFree() */
+    long            numIdentTokens, numStringTokens, lexemeBytes;
+};
+
+#endif
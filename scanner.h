@@ -9,7 +9,11 @@
 #ifndef _H_scanner
 #define _H_scanner
 
+#include "arena.h"
+
 class Declaration;
+class SymbolTable;
+typedef struct SymbolDictionaryImplementation *SymbolDictionary;   // see symdict.h
 
 /*
  * Typedef: TokenType enum
@@ -48,6 +52,21 @@ static const char *gTokenNames[T_NumTokenTypes] = {
 };
 
  
+/*
+ * Typedef: StringRef
+ * ------------------
+ * A view of a string constant's text: length characters starting at
+ * chars, which are NOT null-terminated.  The text lives in the mapped
+ * input file or in the scanner's string pool, and repeated literals
+ * share one view.  It stays valid until Finishyylex() (or ScannerFree()); call
+ * CopyString(ref) for a copy of your own.
+ */
+typedef struct {
+    const char *chars;
+    int length;
+} StringRef;
+
+
 /*
  * Typedef: YYSTYPE
  * ----------------
@@ -58,7 +77,7 @@ static const char *gTokenNames[T_NumTokenTypes] = {
 typedef union {
     int integerConstant;
     bool boolConstant;
-    char *stringConstant;
+    StringRef stringConstant;
     double doubleConstant;
     Declaration *decl;
 } YYSTYPE;
@@ -94,9 +113,227 @@ struct yyltype {
 extern struct yyltype yylloc;
 
 
+/*
+ * yytext and yyleng are macros inside the generated lex.yy.c (they
+ * name the current scanner instance's lexeme), so the globals are only
+ * declared for everybody else.
+ */
+#ifndef yytext
 extern char *yytext;     // Text of lexeme just scanned
+extern int yyleng;       // Length of yytext
+#endif
 
-int yylex(void);         // Defined in the generated lex.yy.c file
+int yylex(void);         // Defined in scanner.l, scans with the default Scanner
 void Inityylex();        // Defined in scanner.l user subroutine section
+void Inityylex(const char *filename);   // Ditto, scans a file in place
+void Finishyylex();      // Ditto, releases everything Inityylex/yylex built
+void SetyylexMemoryBudget(long budget); // Ditto, see ScannerSetMemoryBudget()
+
+
+/*
+ * Type: Scanner
+ * -------------
+ * One independent scanner: its own input, position, symbol table and
+ * string pool.  The classic functions above drive a single default
+ * Scanner and copy each token out to the globals; code that scans
+ * several inputs at once (e.g. on different threads) makes a Scanner
+ * for each and uses the functions below instead.  A Scanner must only
+ * be used by one thread at a time.
+ */
+typedef struct ScannerImplementation *Scanner;
+
+/*
+ * Type: ScannerEngine
+ * -------------------
+ * What does the scanning.  FlexEngine is the flex-generated scanner
+ * from scanner.l.  FastEngine is a hand-written one (see fastscan.h)
+ * that returns exactly the same tokens, values, positions and errors,
+ * but skips whitespace, comments and string bodies many bytes at a
+ * time.
+ */
+typedef enum { FlexEngine, FastEngine } ScannerEngine;
+
+/*
+ * Function: SetScannerEngine()
+ * Usage: SetScannerEngine(FastEngine);
+ * ------------------------------------
+ * Picks the engine for the scanners made from now on, including the
+ * one behind Inityylex().  The default is FlexEngine.  Not to be
+ * called while other threads are making scanners.
+ */
+void SetScannerEngine(ScannerEngine engine);
+
+/*
+ * Function: SetScannerDictionary()
+ * Usage: SetScannerDictionary(SymbolDictionaryOpen("decaf.pp1d"));
+ * ----------------------------------------------------------------
+ * Gives the scanners made from now on a shared symbol dictionary (see
+ * symdict.h) to look identifiers up in before their own tables, or
+ * none if dict is NULL, the default.  The dictionary must outlive
+ * them.  Not to be called while other threads are making scanners.
+ */
+void SetScannerDictionary(SymbolDictionary dict);
+
+/*
+ * Function: ScannerNew()
+ * Usage: scanner = ScannerNew("program.decaf", NULL);
+ * ---------------------------------------------------
+ * Makes a scanner for the named file, which is scanned in place, or
+ * for stdin if filename is NULL.  Everything the scanner allocates
+ * comes from storage; if that is NULL the scanner makes an arena of
+ * its own.
+ */
+Scanner ScannerNew(const char *filename, Arena storage);
+
+/*
+ * Function: ScannerNewChunk()
+ * Usage: scanner = ScannerNewChunk(file, offset, length, 0, NULL);
+ * ----------------------------------------------------------------
+ * Makes a scanner for just length bytes of the named file, starting at
+ * offset, which must be the start of a line.  Lines are counted from 1
+ * at offset.  If commentDepth is more than 0 the chunk starts that
+ * deep inside nested comments, as when the chunk before it ended
+ * there.  Running out of input inside a comment is only an error in
+ * the file's last chunk; see ScannerCommentDepth().
+ */
+Scanner ScannerNewChunk(const char *filename, long offset, long length,
+                        int commentDepth, Arena storage);
+
+/*
+ * Function: ScannerNewText()
+ * Usage: scanner = ScannerNewText(line, length, depth, true, NULL);
+ * -----------------------------------------------------------------
+ * Makes a scanner for length characters of text in memory, which it
+ * copies, so text can change or go away once this returns.  Lines are
+ * counted from 1 at text.  commentDepth and endsMidText are as for
+ * ScannerNewChunk(): endsMidText means more input follows the text, so
+ * running out of it inside a comment isn't an error.
+ */
+Scanner ScannerNewText(const char *text, long length, int commentDepth,
+                       bool endsMidText, Arena storage);
+
+/*
+ * Function: ScannerSetText()
+ * --------------------------
+ * Points a scanner made by ScannerNewText() at new text, as if it had
+ * just been made for it.  Only the symbol table and string pool carry
+ * over from the old text, so scanning many short pieces of text (e.g.
+ * the lines of an editor buffer) costs no new scanner for each one.
+ */
+void ScannerSetText(Scanner scanner, const char *text, long length, int commentDepth,
+                    bool endsMidText);
+
+/*
+ * Function: ScannerNextToken()
+ * ----------------------------
+ * Scans the next token and returns its type, or 0 at the end of the
+ * input.  The token's text, value and position are then available
+ * from the accessors below until the next call.
+ */
+int ScannerNextToken(Scanner scanner);
+
+char *ScannerText(Scanner scanner);                 // like yytext
+int ScannerLength(Scanner scanner);                 // like yyleng
+YYSTYPE ScannerValue(Scanner scanner);              // like yylval
+struct yyltype ScannerLocation(Scanner scanner);    // like yylloc
+
+/*
+ * Type: TokenBlock
+ * ----------------
+ * A batch of tokens laid out as one array per field, for consumers
+ * that take tokens many at a time: token i of the block is types[i],
+ * on line lines[i] from column firstColumns[i] to lastColumns[i], with
+ * value values[i] and text lexemes[i].  Each array has room for
+ * capacity tokens, and count says how many are filled in.
+ *
+ * The caller supplies the arrays; TokenBlockNew() makes a block with
+ * all of them, each aligned for vector loads.
+ */
+typedef struct {
+    int         capacity;           // tokens each array has room for
+    int         count;              // tokens filled in
+    int         *types;             // TokenType or char
+    int         *lines;
+    int         *firstColumns, *lastColumns;
+    YYSTYPE     *values;
+    StringRef   *lexemes;           // NOT null-terminated
+} TokenBlock;
+
+/*
+ * Function: ScannerNextBlock()
+ * Usage: while (ScannerNextBlock(scanner, block) > 0) ...
+ * -------------------------------------------------------
+ * Scans up to block->capacity tokens into block, the way as many calls
+ * to ScannerNextToken() and the accessors would, and returns how many
+ * it scanned: fewer than capacity only at the end of the input, and 0
+ * after that.  Lexemes point into the scanner's input where it is
+ * all in memory (a file, or text), and are copied into the scanner's
+ * storage when flex is reading stdin; either way they stay valid until
+ * ScannerFree() or the next ScannerSetText().  Errors are reported as
+ * usual while the block is being filled, so they come out ahead of
+ * the block's tokens rather than among them.
+ */
+int ScannerNextBlock(Scanner scanner, TokenBlock *block);
+
+/*
+ * Function: TokenBlockNew()
+ * Usage: block = TokenBlockNew(256);
+ * ----------------------------------
+ * Makes an empty TokenBlock with room for capacity tokens.
+ */
+TokenBlock *TokenBlockNew(int capacity);
+
+/*
+ * Function: TokenBlockFree()
+ * --------------------------
+ * Frees a block made by TokenBlockNew().
+ */
+void TokenBlockFree(TokenBlock *block);
+
+/*
+ * Function: ScannerSetMemoryBudget()
+ * Usage: ScannerSetMemoryBudget(scanner, 8 << 20);
+ * ------------------------------------------------
+ * Puts the scanner in streaming mode, for input of any length: once it
+ * has used more than budget bytes of storage (beyond what its empty
+ * symbol table and string pool take), it reclaims all of it
+ * before scanning the next token (or block).  Its symbol table is first
+ * spilled to disk (see spill.h), so every identifier keeps its exact
+ * count, first line and id, but everything returned for earlier tokens
+ * is gone: a token's text, value and Declaration are only good until
+ * the next token is scanned, and ScannerSymbols() has only the names
+ * seen since storage was last reclaimed.  The flex engine's buffer is
+ * bounded too, so its memory use stays flat however much input goes
+ * through; the fast engine reads all of stdin in at once, so it isn't
+ * for streaming stdin.  A budget of 0 turns streaming back off.
+ */
+void ScannerSetMemoryBudget(Scanner scanner, long budget);
+
+/*
+ * Function: ScannerSymbols()
+ * --------------------------
+ * Returns the table of every identifier the scanner has seen so far.
+ * It belongs to the scanner and goes away with it.
+ */
+SymbolTable *ScannerSymbols(Scanner scanner);
+
+/*
+ * Function: ScannerCommentDepth()
+ * -------------------------------
+ * Returns how many comments deep the scanner is, 0 if it isn't in one.
+ * Once a chunk has been scanned to the end, this is the commentDepth
+ * to start the next chunk with.
+ */
+int ScannerCommentDepth(Scanner scanner);
+
+/*
+ * Function: ScannerFree()
+ * -----------------------
+ * Frees the scanner along with everything it handed out: Declarations,
+ * string constants and the symbol table.  Storage passed to
+ * ScannerNew() is reset rather than freed, so it can be given to the
+ * next scanner.
+ */
+void ScannerFree(Scanner scanner);
 
 #endif
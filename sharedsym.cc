@@ -0,0 +1,201 @@
+/* File: sharedsym.cc
+ * ------------------
+ * Implementation of the lock-free SharedSymbolTable class.  See
+ * sharedsym.h for comments.
+ *
+ * A symbol is published by the release of the compare-and-swap that
+ * puts it at the head of its chain, and every chain is read from an
+ * acquire of its head, so a thread that finds a symbol sees all of it.
+ * The counts are only ever added to or lowered, in any order, so their
+ * updates can be relaxed: the totals are the same whatever order they
+ * come in, and they are read once the threads adding to them are done.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "sharedsym.h"
+#include "declaration.h"
+
+#define MIN_BUCKETS     1024
+#define BLOCK_SIZE      (64 * 1024)
+
+struct SharedSymbolTable::Block {
+    Block               *next;
+    size_t              size;           // bytes after the header
+    std::atomic<size_t> used;           // bytes handed out, or more
+};
+
+
+SharedSymbolTable::SharedSymbolTable(int sizeHint)
+{
+    unsigned int    numBuckets = MIN_BUCKETS, i;
+
+    assert(sizeHint >= 0);
+
+    while (numBuckets < (unsigned int)sizeHint)
+        numBuckets *= 2;
+    buckets = (std::atomic<SharedSymbol *> *) malloc(numBuckets * sizeof(*buckets));
+    Assert(buckets != NULL);
+    for (i = 0; i < numBuckets; i++)
+        new(&buckets[i]) std::atomic<SharedSymbol *>(NULL);
+    mask = numBuckets - 1;
+    count = 0;
+    nextId = 0;
+    blocks = NULL;
+}
+
+
+SharedSymbolTable::~SharedSymbolTable()
+{
+    Block   *b, *next;
+
+    for (b = blocks; b != NULL; b = next) {
+        next = b->next;
+        free(b);
+    }
+    free(buckets);
+}
+
+
+int SharedSymbolTable::Count()
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+
+/*
+ * Function: Allocate()
+ * --------------------
+ * Returns size bytes, aligned for a SharedSymbol, from the newest
+ * block.  A thread that finds the block full makes a new one and
+ * swaps it in; if another thread beat it to that, it drops its own
+ * and tries again in theirs.
+ */
+void *SharedSymbolTable::Allocate(size_t size)
+{
+    Block       *b, *fresh;
+    size_t      at;
+
+    size = (size + alignof(SharedSymbol) - 1) & ~(alignof(SharedSymbol) - 1);
+    for (;;) {
+        b = blocks.load(std::memory_order_acquire);
+        if (b != NULL) {
+            at = b->used.fetch_add(size, std::memory_order_relaxed);
+            if (at + size <= b->size)
+                return (char *)(b + 1) + at;
+        }
+        fresh = (Block *) malloc(sizeof(Block) + (size > BLOCK_SIZE ? size : BLOCK_SIZE));
+        Assert(fresh != NULL);
+        fresh->next = b;
+        fresh->size = (size > BLOCK_SIZE ? size : BLOCK_SIZE);
+        new(&fresh->used) std::atomic<size_t>(0);
+        if (!blocks.compare_exchange_strong(b, fresh, std::memory_order_acq_rel))
+            free(fresh);
+    }
+}
+
+
+/*
+ * Function: Find()
+ * ----------------
+ * Returns the symbol for the name in the chain from from up to, but
+ * not including, to, or NULL if there isn't one.
+ */
+SharedSymbol *SharedSymbolTable::Find(SharedSymbol *from, SharedSymbol *to, const char *name,
+                                      int length, HashCode hash)
+{
+    SharedSymbol    *s;
+
+    for (s = from; s != to; s = s->next)
+        if (s->hash == hash && s->length == length && memcmp(s->name, name, length) == 0)
+            return s;
+    return NULL;
+}
+
+
+SharedSymbol *SharedSymbolTable::Lookup(const char *name, int length)
+{
+    HashCode        hash = StringHashCode(name, length);
+
+    assert(name != NULL);
+    return Find(buckets[hash & mask].load(std::memory_order_acquire), NULL, name, length, hash);
+}
+
+
+SharedSymbol *SharedSymbolTable::Add(const char *name, int length, HashCode hash, int occurrences,
+                                     int firstLine)
+{
+    std::atomic<SharedSymbol *> *bucket = &buckets[hash & mask];
+    SharedSymbol    *head, *found, *fresh;
+    char            *copy;
+    int             line;
+
+    assert(name != NULL && length > 0);
+
+    head = bucket->load(std::memory_order_acquire);
+    if ((found = Find(head, NULL, name, length, hash)) == NULL) {
+
+        // a new name, as far as this thread can tell: fill in its
+        // symbol and try to swap it in.  Whenever another thread swaps
+        // in first, only the symbols it pushed ahead of ours need
+        // checking for the name.
+
+        fresh = (SharedSymbol *) Allocate(sizeof(SharedSymbol) + length + 1);
+        copy = (char *)(fresh + 1);
+        memcpy(copy, name, length);
+        copy[length] = '\0';
+        fresh->name = copy;
+        fresh->length = length;
+        fresh->hash = hash;
+        fresh->id = nextId.fetch_add(1, std::memory_order_relaxed);
+        new(&fresh->occurrences) std::atomic<int>(occurrences);
+        new(&fresh->firstLine) std::atomic<int>(firstLine);
+        for (;;) {
+            fresh->next = head;
+            if (bucket->compare_exchange_weak(head, fresh, std::memory_order_release,
+                                              std::memory_order_acquire)) {
+                count.fetch_add(1, std::memory_order_relaxed);
+                return fresh;
+            }
+            if ((found = Find(head, fresh->next, name, length, hash)) != NULL)
+                break;
+        }
+    }
+
+    found->occurrences.fetch_add(occurrences, std::memory_order_relaxed);
+    line = found->firstLine.load(std::memory_order_relaxed);
+    while (firstLine < line
+           && !found->firstLine.compare_exchange_weak(line, firstLine, std::memory_order_relaxed))
+        ;
+    return found;
+}
+
+
+SharedSymbol *SharedSymbolTable::Intern(const char *name, int length, int lineFound)
+{
+    return Add(name, length, StringHashCode(name, length), 1, lineFound);
+}
+
+
+SharedSymbol *SharedSymbolTable::Merge(Declaration *decl)
+{
+    assert(decl != NULL);
+
+    return Add(decl->GetName(), decl->GetLength(), decl->GetHash(), decl->GetOccurrences(),
+               decl->GetFirstLine());
+}
+
+
+void SharedSymbolTable::Map(SharedSymbolMapFn fn, void *clientData)
+{
+    SharedSymbol    *s;
+    unsigned int    i;
+
+    assert(fn != NULL);
+
+    for (i = 0; i <= mask; i++)
+        for (s = buckets[i].load(std::memory_order_acquire); s != NULL; s = s->next)
+            (*fn)(s, clientData);
+}
@@ -0,0 +1,108 @@
+/*
+ * File: sharedsym.h
+ * -----------------
+ * A SharedSymbolTable is one table of identifier counts that any number
+ * of threads add to at once, such as the multi-file driver's workers,
+ * each folding in the files it has scanned (see driver.h).  Nothing in
+ * it takes a lock: lookups only read, a new name goes in with a single
+ * compare-and-swap, and counts are bumped with atomic adds, so no
+ * thread ever waits for another to finish.
+ *
+ * The table is an array of buckets, each the head of a chain of
+ * SharedSymbols.  A new name is filled in completely and then swapped
+ * in at the head of its chain; a thread that loses the swap to another
+ * looks through just the symbols pushed in ahead of it, and adds to the
+ * name's counts if one of them is it.  Symbols are never moved or
+ * removed, so a pointer to one is good for the life of the table, and
+ * each name has the same id for every thread.  A thread that loses
+ * the race for a new name gives up the id it drew, so ids are unique
+ * but may skip.
+ *
+ * The number of buckets is fixed when the table is made, so the size
+ * hint should be a real estimate of the names to come (ScanFiles() goes
+ * by the size of its input).  A table holding more names than it has
+ * buckets still works, just with longer chains.  Symbols and their
+ * names come from blocks that are bumped with an atomic add, and are
+ * all freed with the table.
+ */
+
+#ifndef _H_sharedsym
+#define _H_sharedsym
+
+#include <atomic>
+#include "utility.h"
+
+class Declaration;
+
+/*
+ * Type: SharedSymbol
+ * ------------------
+ * One name's counts, which Declaration::MergeCounts() would keep:
+ * occurrences add up, and the first line is the earliest seen.  The
+ * other fields never change once the symbol is in the table.
+ */
+struct SharedSymbol {
+    const char          *name;          // null-terminated, in the table
+    int                 length;
+    HashCode            hash;           // StringHashCode(name, length)
+    int                 id;
+    std::atomic<int>    occurrences;
+    std::atomic<int>    firstLine;
+    SharedSymbol        *next;          // the rest of its bucket's chain
+};
+
+typedef void (*SharedSymbolMapFn)(SharedSymbol *symbol, void *clientData);
+
+class SharedSymbolTable
+{
+  private:
+    struct Block;
+
+    std::atomic<SharedSymbol *> *buckets;
+    unsigned int mask;          // number of buckets - 1, a power of two
+    std::atomic<int> count;     // number of symbols
+    std::atomic<int> nextId;    // id for the next new symbol
+    std::atomic<Block *> blocks; // storage, newest block first
+
+    void *Allocate(size_t size);
+    SharedSymbol *Find(SharedSymbol *from, SharedSymbol *to, const char *name, int length,
+                       HashCode hash);
+
+  public:
+
+    /* Makes an empty table with about one bucket for each of
+     * sizeHint names. */
+    SharedSymbolTable(int sizeHint);
+
+    /* Frees the table and every symbol in it.  No other thread may
+     * be using it. */
+    ~SharedSymbolTable();
+
+    /* Returns the number of names in the table. */
+    int Count();
+
+    /* Returns the symbol for the first length characters of name,
+     * or NULL if no such name has been added. */
+    SharedSymbol *Lookup(const char *name, int length);
+
+    /* Adds occurrences to the count of the first length characters
+     * of name, whose StringHashCode() is hash, and lowers its first
+     * line to firstLine if that is earlier.  A name not in the table
+     * yet goes in with these counts.  Returns the name's symbol. */
+    SharedSymbol *Add(const char *name, int length, HashCode hash, int occurrences,
+                      int firstLine);
+
+    /* Same as above, for one occurrence on line lineFound. */
+    SharedSymbol *Intern(const char *name, int length, int lineFound);
+
+    /* Same as above, for the counts of a Declaration from a thread's
+     * own table.  The Declaration's cached hash is reused. */
+    SharedSymbol *Merge(Declaration *decl);
+
+    /* Calls fn on every symbol in the table, in no particular order.
+     * Safe while other threads add to the table, but names they add
+     * meanwhile may or may not be seen. */
+    void Map(SharedSymbolMapFn fn, void *clientData);
+};
+
+#endif
@@ -0,0 +1,255 @@
+/* File: spill.cc
+ * --------------
+ * Implementation of the on-disk symbol spill.  See spill.h for
+ * comments.
+ *
+ * The index file starts out as a hole of zeros, which reads back as
+ * empty slots, and doubles whenever it becomes half full: the entries
+ * are read back a batch at a time and entered in a new file, so growing
+ * takes no more memory than one batch.  A lookup reads a run of slots
+ * at a time, and a name only when the slot's hash and length match.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "spill.h"
+#include "declaration.h"
+
+#define MIN_CAPACITY        1024    // slots in a new index
+#define PROBE_RUN           8       // slots read at once by a lookup
+#define GROW_BATCH          1024    // slots read at once by Grow()
+
+static DebugChannel gMemDebug = DebugChannelNew("mem");
+
+
+struct SymbolSpillImplementation {
+    int             slotFd;         // the index
+    int             nameFd;         // the names
+    long            capacity;       // slots in the index, a power of two
+    int             count;          // slots in use
+    uint64_t        nameBytes;      // length of the name file
+    char            *name;          // a name read back, to compare
+    int             nameCapacity;
+};
+
+
+/*
+ * Function: TempFile()
+ * --------------------
+ * Opens a new temporary file and unlinks it, so that it goes away
+ * when it is closed, even if pp1 dies first.
+ */
+static int TempFile()
+{
+    const char  *dir = getenv("TMPDIR");
+    char        path[1024];
+    int         fd;
+
+    snprintf(path, sizeof(path), "%s/pp1-spill-XXXXXX", dir != NULL && *dir ? dir : "/tmp");
+    if ((fd = mkstemp(path)) < 0)
+        Failure("Can't make spill file %s: %s", path, strerror(errno));
+    unlink(path);
+    return fd;
+}
+
+
+static void ReadAt(int fd, void *buffer, size_t size, off_t offset)
+{
+    char        *p = (char *) buffer;
+    ssize_t     n;
+
+    while (size > 0) {
+        if ((n = pread(fd, p, size, offset)) < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            Failure("Can't read spill file: %s", n < 0 ? strerror(errno) : "short file");
+        p += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+
+static void WriteAt(int fd, const void *buffer, size_t size, off_t offset)
+{
+    const char  *p = (const char *) buffer;
+    ssize_t     n;
+
+    while (size > 0) {
+        if ((n = pwrite(fd, p, size, offset)) < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            Failure("Can't write spill file: %s", strerror(errno));
+        p += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+
+/* Makes an index file of capacity empty slots */
+static int NewIndex(long capacity)
+{
+    int         fd = TempFile();
+
+    if (ftruncate(fd, capacity * sizeof(SpillSlot)) < 0)
+        Failure("Can't size spill file: %s", strerror(errno));
+    return fd;
+}
+
+
+SymbolSpill SymbolSpillNew()
+{
+    SymbolSpill spill;
+
+    spill = (SymbolSpill) malloc(sizeof(struct SymbolSpillImplementation));
+    Assert(spill != NULL);
+    spill->capacity = MIN_CAPACITY;
+    spill->slotFd = NewIndex(spill->capacity);
+    spill->nameFd = TempFile();
+    spill->count = 0;
+    spill->nameBytes = 0;
+    spill->name = NULL;
+    spill->nameCapacity = 0;
+    return spill;
+}
+
+
+void SymbolSpillFree(SymbolSpill spill)
+{
+    close(spill->slotFd);
+    close(spill->nameFd);
+    free(spill->name);
+    free(spill);
+}
+
+
+int SymbolSpillCount(SymbolSpill spill)
+{
+    return spill->count;
+}
+
+
+/*
+ * Function: SameName()
+ * --------------------
+ * Returns true if slot is for the first length characters of name.
+ */
+static bool SameName(SymbolSpill spill, const SpillSlot *slot, const char *name, int length,
+                     HashCode hash)
+{
+    if (slot->hash != hash || slot->nameLength != length)
+        return false;
+    if (length > spill->nameCapacity) {
+        spill->nameCapacity = 2 * length;
+        free(spill->name);
+        spill->name = (char *) malloc(spill->nameCapacity);
+        Assert(spill->name != NULL);
+    }
+    ReadAt(spill->nameFd, spill->name, length, slot->nameOffset);
+    return memcmp(spill->name, name, length) == 0;
+}
+
+
+/*
+ * Function: FindSlot()
+ * --------------------
+ * Probes the index in fd, of capacity slots, for the name, and sets
+ * *index to the slot that has it or, if none does, the empty slot
+ * where it would go.  Fills in slot with what is there and returns
+ * true if the name was found.  With name NULL, just finds the empty
+ * slot (as when entering names that are known to be new).
+ */
+static bool FindSlot(SymbolSpill spill, int fd, long capacity, const char *name, int length,
+                     HashCode hash, SpillSlot *slot, long *index)
+{
+    SpillSlot   run[PROBE_RUN];
+    long        mask = capacity - 1;
+    long        n = hash & mask;
+    int         i, runLength;
+
+    // the load factor keeps at least half the slots empty, so
+    // the loop always ends
+
+    for (;;) {
+        runLength = (capacity - n < PROBE_RUN ? capacity - n : PROBE_RUN);
+        ReadAt(fd, run, runLength * sizeof(SpillSlot), n * sizeof(SpillSlot));
+        for (i = 0; i < runLength; i++) {
+            if (run[i].nameLength == 0
+                || (name != NULL && SameName(spill, &run[i], name, length, hash))) {
+                *slot = run[i];
+                *index = n + i;
+                return run[i].nameLength != 0;
+            }
+        }
+        n = (n + runLength) & mask;
+    }
+}
+
+
+static void Grow(SymbolSpill spill)
+{
+    SpillSlot   *batch;
+    SpillSlot   empty;
+    long        capacity = 2 * spill->capacity;
+    long        i, index;
+    int         j, batchLength;
+    int         fd = NewIndex(capacity);
+
+    batch = (SpillSlot *) malloc(GROW_BATCH * sizeof(SpillSlot));
+    Assert(batch != NULL);
+    for (i = 0; i < spill->capacity; i += batchLength) {
+        batchLength = (spill->capacity - i < GROW_BATCH ? spill->capacity - i : GROW_BATCH);
+        ReadAt(spill->slotFd, batch, batchLength * sizeof(SpillSlot), i * sizeof(SpillSlot));
+        for (j = 0; j < batchLength; j++) {
+            if (batch[j].nameLength == 0)
+                continue;
+            FindSlot(spill, fd, capacity, NULL, 0, batch[j].hash, &empty, &index);
+            WriteAt(fd, &batch[j], sizeof(SpillSlot), index * sizeof(SpillSlot));
+        }
+    }
+    free(batch);
+
+    close(spill->slotFd);
+    spill->slotFd = fd;
+    spill->capacity = capacity;
+    DebugPrint(gMemDebug, "spill index grown to %ld slots", capacity);
+}
+
+
+void SymbolSpillStore(SymbolSpill spill, Declaration *decl)
+{
+    SpillSlot   slot;
+    long        index;
+
+    if (!FindSlot(spill, spill->slotFd, spill->capacity, decl->GetName(), decl->GetLength(),
+                  decl->GetHash(), &slot, &index)) {
+        if ((spill->count + 1) * 2 > spill->capacity) {
+            Grow(spill);
+            FindSlot(spill, spill->slotFd, spill->capacity, NULL, 0, decl->GetHash(), &slot,
+                     &index);
+        }
+        slot.hash = decl->GetHash();
+        slot.nameOffset = spill->nameBytes;
+        slot.nameLength = decl->GetLength();
+        WriteAt(spill->nameFd, decl->GetName(), decl->GetLength(), spill->nameBytes);
+        spill->nameBytes += decl->GetLength();
+        spill->count++;
+    }
+    slot.id = decl->GetId();
+    slot.occurrences = decl->GetOccurrences();
+    slot.firstLine = decl->GetFirstLine();
+    WriteAt(spill->slotFd, &slot, sizeof(SpillSlot), index * sizeof(SpillSlot));
+}
+
+
+bool SymbolSpillFetch(SymbolSpill spill, const char *name, int length, HashCode hash,
+                      SpillSlot *slot)
+{
+    long        index;
+
+    Assert(length > 0);
+    return FindSlot(spill, spill->slotFd, spill->capacity, name, length, hash, slot, &index);
+}
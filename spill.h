@@ -0,0 +1,80 @@
+/*
+ * File: spill.h
+ * -------------
+ * A SymbolSpill is the cold tier of a symbol table that scans input of
+ * unbounded length in bounded memory (see ScannerSetMemoryBudget() in
+ * scanner.h).  When the scanner reclaims its storage, every Declaration
+ * in its SymbolTable is written out here first: name, occurrence
+ * count, first line and id.  A name the table no longer has is looked
+ * up here before it is made new, and picks up where it left off, so
+ * counts and ids stay exact however often storage is reclaimed.
+ *
+ * The spill lives on disk, in two unlinked temporary files: a hash
+ * index of fixed-size SpillSlots, open-addressed with linear probing
+ * like SymbolTable, and the names the slots point to, appended one
+ * after the other.  Both are read and written with pread()/pwrite()
+ * rather than mapped, so what the spill holds sits in the page cache
+ * and not in the process's own memory, and its memory use stays the
+ * same however many names it holds.
+ */
+
+#ifndef _H_spill
+#define _H_spill
+
+#include <stdint.h>
+#include "utility.h"
+
+class Declaration;
+
+typedef struct {
+    uint64_t    hash;               // StringHashCode() of the name
+    uint64_t    nameOffset;         // where the name is in the name file
+    int32_t     nameLength;         // 0 if the slot is empty
+    int32_t     id;
+    int32_t     occurrences;
+    int32_t     firstLine;
+} SpillSlot;
+
+typedef struct SymbolSpillImplementation *SymbolSpill;
+
+/*
+ * Function: SymbolSpillNew()
+ * --------------------------
+ * Makes an empty spill, with its files in $TMPDIR (or /tmp).
+ */
+SymbolSpill SymbolSpillNew();
+
+/*
+ * Function: SymbolSpillFree()
+ * ---------------------------
+ * Frees the spill; its files go away with it.
+ */
+void SymbolSpillFree(SymbolSpill spill);
+
+/*
+ * Function: SymbolSpillCount()
+ * ----------------------------
+ * Returns the number of distinct names in the spill.
+ */
+int SymbolSpillCount(SymbolSpill spill);
+
+/*
+ * Function: SymbolSpillStore()
+ * ----------------------------
+ * Records decl's counts and id under its name, replacing what was
+ * stored for that name before.
+ */
+void SymbolSpillStore(SymbolSpill spill, Declaration *decl);
+
+/*
+ * Function: SymbolSpillFetch()
+ * Usage: if (SymbolSpillFetch(spill, yytext, yyleng, hash, &slot)) ...
+ * --------------------------------------------------------------------
+ * Looks up the first length characters of name, whose StringHashCode()
+ * is hash.  If the name was stored, fills in slot with what was stored
+ * for it and returns true; otherwise returns false.
+ */
+bool SymbolSpillFetch(SymbolSpill spill, const char *name, int length, HashCode hash,
+                      SpillSlot *slot);
+
+#endif
@@ -0,0 +1,108 @@
+/* File: strpool.cc
+ * ----------------
+ * Implementation of the StringPool class.  See strpool.h for comments.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "strpool.h"
+#include "profile.h"
+
+#define MIN_CAPACITY 16
+
+
+StringPool::StringPool(int sizeHint, Arena storage)
+{
+    assert(sizeHint >= 0);
+    assert(storage != NULL);
+
+    arena = storage;
+    capacity = MIN_CAPACITY;
+    while (capacity * 3 / 4 < sizeHint)
+        capacity *= 2;
+    slots = NewSlots(capacity);
+    count = 0;
+}
+
+
+StringPool::Slot *StringPool::NewSlots(int n)
+{
+    Slot    *result;
+
+    // slots are zeroed so that every ref.chars starts out NULL
+
+    result = (Slot *) ArenaAlloc(arena, n * sizeof(Slot));
+    memset(result, 0, n * sizeof(Slot));
+    return result;
+}
+
+
+int StringPool::Count()
+{
+    return count;
+}
+
+
+StringPool::Slot *StringPool::FindSlot(const char *text, int length, HashCode hash)
+{
+    unsigned int    mask = capacity - 1;
+    unsigned int    n;
+
+    for (n = hash & mask; slots[n].ref.chars != NULL; n = (n + 1) & mask)
+        if (slots[n].hash == hash && slots[n].ref.length == length
+            && memcmp(slots[n].ref.chars, text, length) == 0)
+            break;
+
+    return &slots[n];
+}
+
+
+void StringPool::Grow()
+{
+    Slot            *oldSlots = slots;
+    int             oldCapacity = capacity;
+    unsigned int    mask;
+    unsigned int    n;
+    int             i;
+
+    capacity *= 2;
+    mask = capacity - 1;
+    slots = NewSlots(capacity);
+
+    for (i = 0; i < oldCapacity; i++) {
+        if (oldSlots[i].ref.chars == NULL)
+            continue;
+        for (n = oldSlots[i].hash & mask; slots[n].ref.chars != NULL; n = (n + 1) & mask)
+            ;
+        slots[n] = oldSlots[i];
+    }
+}
+
+
+StringRef StringPool::Intern(const char *text, int length, bool stable)
+{
+    HashCode        hash;
+    Slot            *slot;
+
+    assert(text != NULL);
+    assert(length >= 0);
+
+    hash = StringHashCode(text, length);
+    slot = FindSlot(text, length, hash);
+    if (slot->ref.chars != NULL) {
+        PROFILE_COUNT(ProfileStringHits, 1);
+        return slot->ref;
+    }
+    PROFILE_COUNT(ProfileStringMisses, 1);
+
+    if ((count + 1) * 4 > capacity * 3) {
+        Grow();
+        slot = FindSlot(text, length, hash);
+    }
+
+    slot->hash = hash;
+    slot->ref.chars = stable ? text : ArenaCopyString(arena, text, length);
+    slot->ref.length = length;
+    count++;
+    return slot->ref;
+}
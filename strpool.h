@@ -0,0 +1,55 @@
+/*
+ * File: strpool.h
+ * ---------------
+ * A StringPool hands out one shared StringRef for every distinct string
+ * given to it, so the scanner can return string constants without
+ * copying each one.  The first occurrence of a string is either kept
+ * where it is (when the caller says the text is stable, e.g. it lies
+ * in the mapped input file) or copied once into the pool's arena; every
+ * later occurrence gets the same view back without allocating.
+ *
+ * Like SymbolTable, the pool is an open-addressing hash table with a
+ * power-of-two capacity and cached hashes, and all of its memory comes
+ * from an Arena.
+ */
+
+#ifndef _H_strpool
+#define _H_strpool
+
+#include "arena.h"
+#include "utility.h"
+
+class StringPool
+{
+  private:
+    struct Slot {
+        HashCode hash;          // StringHashCode of the text
+        StringRef ref;          // ref.chars is NULL if the slot is empty
+    };
+
+    Slot *slots;
+    int capacity;               // number of slots, always a power of two
+    int count;                  // number of occupied slots
+    Arena arena;                // storage for slots and copied text
+
+    Slot *NewSlots(int n);
+    Slot *FindSlot(const char *text, int length, HashCode hash);
+    void Grow();
+
+  public:
+
+    /* Makes an empty pool with room for at least sizeHint strings
+     * before it needs to grow, drawing memory from storage. */
+    StringPool(int sizeHint, Arena storage);
+
+    /* Returns the number of distinct strings in the pool. */
+    int Count();
+
+    /* Returns the pool's view of the length characters at text.  If
+     * the string is new and stable is true, the view points at text
+     * itself, which must then outlive the pool; otherwise new strings
+     * are copied (null-terminated) into the arena. */
+    StringRef Intern(const char *text, int length, bool stable);
+};
+
+#endif
@@ -0,0 +1,220 @@
+/* File: symdict.cc
+ * ----------------
+ * Implementation of the shared symbol dictionary.  See symdict.h for
+ * comments.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "symdict.h"
+#include "symtab.h"
+#include "declaration.h"
+
+#define MIN_CAPACITY    16
+
+
+struct SymbolDictionaryImplementation {
+    char            *mapped;
+    size_t          mappedSize;
+    const DictionarySlot *slots;
+    uint32_t        mask;           // capacity - 1
+    int             numNames;
+    const char      *text;
+};
+
+
+/*
+ * Function: CheckDictionary()
+ * ---------------------------
+ * Returns true if the mapping is laid out as its header says, every
+ * full slot's name and the '\0' after it are within the names, and
+ * every full slot has a number of its own.  Sets up dict's pointers
+ * into the mapping as it goes.
+ */
+static bool CheckDictionary(SymbolDictionary dict)
+{
+    const SymbolDictionaryHeader *header = (const SymbolDictionaryHeader *) dict->mapped;
+    unsigned char   *seen;
+    uint32_t        i, numFull = 0;
+    bool            ok = true;
+
+    if (dict->mappedSize < sizeof(SymbolDictionaryHeader)
+        || memcmp(header->magic, SYMBOL_DICTIONARY_MAGIC, sizeof(header->magic)) != 0
+        || header->version != SYMBOL_DICTIONARY_VERSION
+        || header->capacity < MIN_CAPACITY || (header->capacity & (header->capacity - 1)) != 0
+        || header->numNames > header->capacity / 2
+        || dict->mappedSize != sizeof(SymbolDictionaryHeader)
+                               + (uint64_t)header->capacity * sizeof(DictionarySlot)
+                               + header->textBytes)
+        return false;
+
+    dict->slots = (const DictionarySlot *) (header + 1);
+    dict->mask = header->capacity - 1;
+    dict->numNames = header->numNames;
+    dict->text = (const char *) (dict->slots + header->capacity);
+
+    seen = (unsigned char *) calloc(header->numNames + 1, 1);
+    Assert(seen != NULL);
+    for (i = 0; i < header->capacity && ok; i++) {
+        const DictionarySlot *slot = &dict->slots[i];
+
+        if (slot->nameLength == 0)
+            continue;
+        ok = (uint64_t)slot->nameOffset + slot->nameLength < header->textBytes
+             && dict->text[slot->nameOffset + slot->nameLength] == '\0'
+             && slot->number < header->numNames && !seen[slot->number];
+        if (ok)
+            seen[slot->number] = 1;
+        numFull++;
+    }
+    free(seen);
+    return ok && numFull == header->numNames;
+}
+
+
+SymbolDictionary SymbolDictionaryOpen(const char *filename)
+{
+    SymbolDictionary    dict;
+    struct stat         st;
+    int                 fd;
+
+    if ((fd = open(filename, O_RDONLY)) < 0 || fstat(fd, &st) < 0)
+        Failure("Can't open symbol dictionary %s: %s", filename, strerror(errno));
+
+    dict = (SymbolDictionary) malloc(sizeof(struct SymbolDictionaryImplementation));
+    Assert(dict != NULL);
+    dict->mappedSize = st.st_size;
+    dict->mapped = (char *) mmap(NULL, st.st_size > 0 ? st.st_size : 1, PROT_READ, MAP_SHARED,
+                                 fd, 0);
+    if (dict->mapped == MAP_FAILED)
+        Failure("Can't map symbol dictionary %s: %s", filename, strerror(errno));
+    close(fd);
+
+    if (!CheckDictionary(dict))
+        Failure("%s is not a usable symbol dictionary", filename);
+    return dict;
+}
+
+
+void SymbolDictionaryClose(SymbolDictionary dict)
+{
+    munmap(dict->mapped, dict->mappedSize > 0 ? dict->mappedSize : 1);
+    free(dict);
+}
+
+
+int SymbolDictionaryCount(SymbolDictionary dict)
+{
+    return dict->numNames;
+}
+
+
+int SymbolDictionaryFind(SymbolDictionary dict, const char *name, int length, HashCode hash)
+{
+    const DictionarySlot    *slot;
+    uint32_t                n;
+
+    // at least half the slots are empty, so the loop always ends
+
+    for (n = hash & dict->mask; (slot = &dict->slots[n])->nameLength != 0; n = (n + 1) & dict->mask)
+        if (slot->hash == hash && slot->nameLength == (uint32_t)length
+            && memcmp(dict->text + slot->nameOffset, name, length) == 0)
+            return slot->number;
+    return -1;
+}
+
+
+typedef struct {
+    Declaration     **decls;
+    int             count;
+    int             minOccurrences;
+} Collection;
+
+static void CollectCommon(Declaration *decl, void *clientData)
+{
+    Collection      *c = (Collection *) clientData;
+
+    if (decl->GetOccurrences() >= c->minOccurrences)
+        c->decls[c->count++] = decl;
+}
+
+
+int SymbolDictionaryWrite(const char *filename, SymbolTable *names, int minOccurrences)
+{
+    SymbolDictionaryHeader  header;
+    DictionarySlot          *slots;
+    Collection              common;
+    char                    *text, *temp;
+    uint64_t                textBytes = 0, offset = 0;
+    uint32_t                capacity = MIN_CAPACITY, n;
+    int                     fd, i;
+    bool                    written;
+
+    Assert(names != NULL);
+
+    common.decls = NULL;
+    if (names->Count() > 0) {
+        common.decls = (Declaration **) malloc(names->Count() * sizeof(Declaration *));
+        Assert(common.decls != NULL);
+    }
+    common.count = 0;
+    common.minOccurrences = minOccurrences;
+    names->Map(CollectCommon, &common);
+
+    // keep the index at most half full, as SymbolDictionaryFind()
+    // counts on
+
+    while (capacity / 2 < (uint32_t)common.count)
+        capacity *= 2;
+    for (i = 0; i < common.count; i++)
+        textBytes += common.decls[i]->GetLength() + 1;
+    if (textBytes > UINT32_MAX)
+        Failure("Too many names for a symbol dictionary");
+
+    slots = (DictionarySlot *) calloc(capacity, sizeof(DictionarySlot));
+    text = (char *) malloc(textBytes + 1);
+    Assert(slots != NULL && text != NULL);
+    for (i = 0; i < common.count; i++) {
+        Declaration *decl = common.decls[i];
+
+        for (n = decl->GetHash() & (capacity - 1); slots[n].nameLength != 0;
+             n = (n + 1) & (capacity - 1))
+            ;
+        slots[n].hash = decl->GetHash();
+        slots[n].nameOffset = offset;
+        slots[n].nameLength = decl->GetLength();
+        slots[n].number = i;
+        memcpy(text + offset, decl->GetName(), decl->GetLength() + 1);
+        offset += decl->GetLength() + 1;
+    }
+
+    memcpy(header.magic, SYMBOL_DICTIONARY_MAGIC, sizeof(header.magic));
+    header.version = SYMBOL_DICTIONARY_VERSION;
+    header.numNames = common.count;
+    header.capacity = capacity;
+    header.textBytes = textBytes;
+
+    temp = (char *) malloc(strlen(filename) + 32);
+    Assert(temp != NULL);
+    sprintf(temp, "%s.tmp-%d", filename, (int)getpid());
+    if ((fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0)
+        Failure("Can't write symbol dictionary %s: %s", temp, strerror(errno));
+    written = WriteAll(fd, &header, sizeof(header))
+              && WriteAll(fd, slots, capacity * sizeof(DictionarySlot))
+              && WriteAll(fd, text, textBytes);
+    if (close(fd) < 0 || !written || rename(temp, filename) < 0) {
+        unlink(temp);
+        Failure("Can't write symbol dictionary %s: %s", filename, strerror(errno));
+    }
+
+    free(temp);
+    free(text);
+    free(slots);
+    free(common.decls);
+    return header.numNames;
+}
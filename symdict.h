@@ -0,0 +1,104 @@
+/*
+ * File: symdict.h
+ * ---------------
+ * A SymbolDictionary is a prebuilt file of the identifiers common to a
+ * codebase, which every pp1 scanning that codebase can map and share.
+ * A SymbolTable given one (see SymbolTable::SetDictionary()) looks each
+ * name up there first.  A name found there needs no string compares in
+ * the private table; the Declaration for it is kept in a side table
+ * keyed on the name's number in the dictionary, which grows with the
+ * names seen rather than with the dictionary.  Only names the
+ * dictionary doesn't have go into the table's own hash table.
+ *
+ * The file is made by pp1dict from a corpus of sources (see dict.cc),
+ * once, and is never changed afterwards.  It is mapped read-only and
+ * shared, so the pages of one dictionary are in memory once, in the
+ * page cache, however many processes use it.  It holds no pointers,
+ * only offsets, so it can be mapped anywhere.
+ *
+ * After its SymbolDictionaryHeader comes the index, open-addressed
+ * with linear probing like SymbolTable: a power of two of
+ * DictionarySlots, at most half of them full.  Then come the names the
+ * slots point to, each followed by a '\0'.  Numbers are in the writer's
+ * native byte order.
+ *
+ * Opening a dictionary checks that every slot is within bounds, so a
+ * bad file can't make a lookup read outside the mapping.  A file that
+ * fails the check is an error.
+ */
+
+#ifndef _H_symdict
+#define _H_symdict
+
+#include <stdint.h>
+#include "utility.h"
+
+class SymbolTable;
+
+#define SYMBOL_DICTIONARY_MAGIC     "PP1D"
+#define SYMBOL_DICTIONARY_VERSION   1
+
+typedef struct {
+    char        magic[4];           // SYMBOL_DICTIONARY_MAGIC
+    uint32_t    version;            // SYMBOL_DICTIONARY_VERSION
+    uint32_t    numNames;           // full slots
+    uint32_t    capacity;           // slots in the index, a power of two
+    uint64_t    textBytes;          // length of the names
+} SymbolDictionaryHeader;
+
+typedef struct {
+    uint64_t    hash;               // StringHashCode() of the name
+    uint32_t    nameOffset;         // where the name is in the names
+    uint32_t    nameLength;         // 0 if the slot is empty
+    uint32_t    number;             // 0, 1, ... numNames - 1
+    uint32_t    unused;
+} DictionarySlot;
+
+typedef struct SymbolDictionaryImplementation *SymbolDictionary;
+
+/*
+ * Function: SymbolDictionaryOpen()
+ * Usage: dict = SymbolDictionaryOpen("decaf.pp1d");
+ * -------------------------------------------------
+ * Maps and checks the dictionary in the named file.  A dictionary can
+ * be used by any number of threads at once.
+ */
+SymbolDictionary SymbolDictionaryOpen(const char *filename);
+
+/*
+ * Function: SymbolDictionaryClose()
+ * ---------------------------------
+ * Unmaps the dictionary.  No table using it may be used afterwards.
+ */
+void SymbolDictionaryClose(SymbolDictionary dict);
+
+/*
+ * Function: SymbolDictionaryCount()
+ * ---------------------------------
+ * Returns the number of names in the dictionary.
+ */
+int SymbolDictionaryCount(SymbolDictionary dict);
+
+/*
+ * Function: SymbolDictionaryFind()
+ * Usage: n = SymbolDictionaryFind(dict, yytext, yyleng, hash);
+ * ------------------------------------------------------------
+ * Looks up the first length characters of name, whose StringHashCode()
+ * is hash.  Returns the name's number in the dictionary, from 0 up to
+ * SymbolDictionaryCount() - 1, or -1 if it isn't there.
+ */
+int SymbolDictionaryFind(SymbolDictionary dict, const char *name, int length, HashCode hash);
+
+/*
+ * Function: SymbolDictionaryWrite()
+ * Usage: SymbolDictionaryWrite("decaf.pp1d", totals, 2);
+ * ------------------------------------------------------
+ * Writes a dictionary of the names in names seen at least
+ * minOccurrences times to the named file, replacing it whole: the
+ * dictionary is written to a temporary file first and renamed into
+ * place, so a pp1 opening it meanwhile gets the old one or the new.
+ * Returns the number of names written.
+ */
+int SymbolDictionaryWrite(const char *filename, SymbolTable *names, int minOccurrences);
+
+#endif
@@ -0,0 +1,411 @@
+/* File: symtab.cc
+ * ---------------
+ * Implementation of the open-addressing SymbolTable class.
+ * See symtab.h for comments.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include "symtab.h"
+#include "declaration.h"
+#include "utility.h"
+#include "profile.h"
+
+#define MIN_CAPACITY 16
+
+
+SymbolTable::Slot *SymbolTable::NewSlots(int n)
+{
+    Slot    *result;
+
+    // slots are zeroed so that every decl starts out NULL
+
+    result = (Slot *) ArenaAlloc(arena, n * sizeof(Slot));
+    memset(result, 0, n * sizeof(Slot));
+    return result;
+}
+
+
+SymbolTable::SymbolTable(int sizeHint, Arena storage)
+{
+    assert(sizeHint >= 0);
+
+    ownsArena = (storage == NULL);
+    arena = (ownsArena ? ArenaNew(0) : storage);
+
+    // pick the smallest power of two that holds sizeHint entries
+    // without passing the 3/4 load factor
+
+    capacity = MIN_CAPACITY;
+    while (capacity * 3 / 4 < sizeHint)
+        capacity *= 2;
+
+    slots = NewSlots(capacity);
+    count = 0;
+    nextId = 0;
+    spill = NULL;
+    dictionary = NULL;
+    dictSlots = NULL;
+    dictCapacity = 0;
+    numDictDecls = 0;
+}
+
+
+SymbolTable::~SymbolTable()
+{
+    if (ownsArena)
+        ArenaFree(arena);
+}
+
+
+int SymbolTable::Count()
+{
+    return count + numDictDecls;
+}
+
+
+SymbolTable::Slot *SymbolTable::FindSlot(const char *name, int length, HashCode hash)
+{
+    unsigned int    mask = capacity - 1;
+    unsigned int    n;
+
+    // probe linearly from the home slot until we find the name or
+    // hit an empty slot.  The cached hash is checked first so that
+    // names are only compared on real candidates.  The load factor
+    // keeps at least one empty slot, so the loop always ends.
+
+    for (n = hash & mask; slots[n].decl != NULL; n = (n + 1) & mask)
+        if (slots[n].hash == hash && slots[n].decl->GetLength() == length
+            && memcmp(slots[n].decl->GetName(), name, length) == 0)
+            break;
+
+    PROFILE_PROBES(((n - (hash & mask)) & mask) + 1);
+    return &slots[n];
+}
+
+
+/*
+ * Function: FindInDictionary()
+ * ----------------------------
+ * Returns the name's number in the dictionary, or -1 if the table has
+ * no dictionary or the name isn't in it.
+ */
+inline int SymbolTable::FindInDictionary(const char *name, int length, HashCode hash)
+{
+    int     n;
+
+    if (dictionary == NULL || (n = SymbolDictionaryFind(dictionary, name, length, hash)) < 0)
+        return -1;
+    PROFILE_COUNT(ProfileDictionaryHits, 1);
+    return n;
+}
+
+
+SymbolTable::DictSlot *SymbolTable::NewDictSlots(int n)
+{
+    DictSlot    *result;
+
+    result = (DictSlot *) ArenaAlloc(arena, n * sizeof(DictSlot));
+    memset(result, 0, n * sizeof(DictSlot));
+    return result;
+}
+
+
+/*
+ * Function: FindDictSlot()
+ * ------------------------
+ * Returns the DictSlot for the dictionary name with the given number,
+ * or the empty one where it would go.  Numbers are all different, so
+ * they are their own hash.
+ */
+inline SymbolTable::DictSlot *SymbolTable::FindDictSlot(int number)
+{
+    unsigned int    mask = dictCapacity - 1;
+    unsigned int    n;
+
+    for (n = number & mask; dictSlots[n].decl != NULL; n = (n + 1) & mask)
+        if (dictSlots[n].number == number)
+            break;
+    return &dictSlots[n];
+}
+
+
+void SymbolTable::GrowDictSlots()
+{
+    DictSlot        *oldSlots = dictSlots;
+    int             oldCapacity = dictCapacity, i;
+
+    dictCapacity *= 2;
+    dictSlots = NewDictSlots(dictCapacity);
+    for (i = 0; i < oldCapacity; i++)
+        if (oldSlots[i].decl != NULL)
+            *FindDictSlot(oldSlots[i].number) = oldSlots[i];
+}
+
+
+/*
+ * Function: EnterInDictionary()
+ * -----------------------------
+ * Keeps decl as the Declaration of the dictionary name with the given
+ * number, which the table hasn't seen before.
+ */
+void SymbolTable::EnterInDictionary(int number, Declaration *decl)
+{
+    DictSlot    *slot;
+
+    if ((numDictDecls + 1) * 4 > dictCapacity * 3)
+        GrowDictSlots();
+    slot = FindDictSlot(number);
+    assert(slot->decl == NULL);
+    slot->number = number;
+    slot->decl = decl;
+    numDictDecls++;
+}
+
+
+/*
+ * Function: NewDeclaration()
+ * --------------------------
+ * Makes the Declaration for a name new to the table.  A name dropped
+ * from the table earlier carries on from the counts it was spilled
+ * with; any other gets the next id.
+ */
+Declaration *SymbolTable::NewDeclaration(const char *name, int length, HashCode hash,
+                                         int lineFound)
+{
+    Declaration     *decl;
+    SpillSlot       spilled;
+
+    decl = new(ArenaAlloc(arena, sizeof(Declaration)))
+                Declaration(name, length, hash, lineFound, arena);
+    if (spill != NULL && SymbolSpillFetch(spill, name, length, hash, &spilled)) {
+        PROFILE_COUNT(ProfileSpillHits, 1);
+        decl->SetId(spilled.id);
+        decl->SetOccurrences(spilled.occurrences + 1);
+        decl->SetFirstLine(spilled.firstLine);
+    } else {
+        decl->SetId(nextId++);
+    }
+    return decl;
+}
+
+
+void SymbolTable::Grow()
+{
+    Slot            *oldSlots = slots;
+    int             oldCapacity = capacity;
+    unsigned int    mask;
+    unsigned int    n;
+    int             i;
+
+    // double the slot array and move every entry to its new home.
+    // The cached hashes mean no names need to be read again.
+
+    capacity *= 2;
+    mask = capacity - 1;
+    slots = NewSlots(capacity);
+
+    for (i = 0; i < oldCapacity; i++) {
+        if (oldSlots[i].decl == NULL)
+            continue;
+        for (n = oldSlots[i].hash & mask; slots[n].decl != NULL; n = (n + 1) & mask)
+            ;
+        slots[n] = oldSlots[i];
+    }
+}
+
+
+Declaration *SymbolTable::Lookup(const char *name)
+{
+    assert(name != NULL);
+
+    return Lookup(name, strlen(name));
+}
+
+
+Declaration *SymbolTable::Lookup(const char *name, int length)
+{
+    HashCode        hash;
+    int             number;
+
+    assert(name != NULL);
+
+    hash = StringHashCode(name, length);
+    if ((number = FindInDictionary(name, length, hash)) >= 0)
+        return FindDictSlot(number)->decl;
+    return FindSlot(name, length, hash)->decl;
+}
+
+
+Declaration *SymbolTable::Intern(const char *name, int length, int lineFound)
+{
+    HashCode        hash;
+    Slot            *slot;
+    DictSlot        *dictSlot;
+    Declaration     *decl;
+    int             number;
+
+    assert(name != NULL);
+
+    hash = StringHashCode(name, length);
+
+    // a name in the dictionary is kept by its number there, so it
+    // needs no slot and never grows the table
+
+    if ((number = FindInDictionary(name, length, hash)) >= 0) {
+        dictSlot = FindDictSlot(number);
+        if (dictSlot->decl != NULL) {
+            PROFILE_COUNT(ProfileSymbolHits, 1);
+            dictSlot->decl->IncrementOccurrences();
+            return dictSlot->decl;
+        }
+        PROFILE_COUNT(ProfileSymbolMisses, 1);
+        decl = NewDeclaration(name, length, hash, lineFound);
+        EnterInDictionary(number, decl);
+        return decl;
+    }
+
+    slot = FindSlot(name, length, hash);
+    if (slot->decl != NULL) {
+        PROFILE_COUNT(ProfileSymbolHits, 1);
+        slot->decl->IncrementOccurrences();
+        return slot->decl;
+    }
+    PROFILE_COUNT(ProfileSymbolMisses, 1);
+
+    // a new name.  If it would push the table past its load factor,
+    // grow and find the empty slot again in the bigger table.
+
+    if ((count + 1) * 4 > capacity * 3) {
+        Grow();
+        slot = FindSlot(name, length, hash);
+    }
+
+    slot->hash = hash;
+    slot->decl = NewDeclaration(name, length, hash, lineFound);
+    count++;
+    return slot->decl;
+}
+
+
+void SymbolTable::Enter(Declaration *decl)
+{
+    Slot            *slot;
+    int             number;
+
+    assert(decl != NULL);
+
+    if ((number = FindInDictionary(decl->GetName(), decl->GetLength(), decl->GetHash())) >= 0) {
+        EnterInDictionary(number, decl);
+        decl->SetId(nextId++);
+        return;
+    }
+
+    // grow first so the new entry never pushes the table past
+    // its load factor
+
+    if ((count + 1) * 4 > capacity * 3)
+        Grow();
+
+    slot = FindSlot(decl->GetName(), decl->GetLength(), decl->GetHash());
+    assert(slot->decl == NULL);
+
+    slot->hash = decl->GetHash();
+    slot->decl = decl;
+    decl->SetId(nextId++);
+    count++;
+}
+
+
+Declaration *SymbolTable::Merge(Declaration *other)
+{
+    Slot            *slot;
+    DictSlot        *dictSlot;
+    Declaration     *decl;
+    int             number;
+
+    assert(other != NULL);
+
+    if ((number = FindInDictionary(other->GetName(), other->GetLength(), other->GetHash())) >= 0) {
+        dictSlot = FindDictSlot(number);
+        if (dictSlot->decl != NULL) {
+            dictSlot->decl->MergeCounts(other);
+            return dictSlot->decl;
+        }
+        decl = new(ArenaAlloc(arena, sizeof(Declaration))) Declaration(other, arena);
+        decl->SetId(nextId++);
+        EnterInDictionary(number, decl);
+        return decl;
+    }
+
+    slot = FindSlot(other->GetName(), other->GetLength(), other->GetHash());
+    if (slot->decl != NULL) {
+        slot->decl->MergeCounts(other);
+        return slot->decl;
+    }
+
+    if ((count + 1) * 4 > capacity * 3) {
+        Grow();
+        slot = FindSlot(other->GetName(), other->GetLength(), other->GetHash());
+    }
+
+    slot->hash = other->GetHash();
+    slot->decl = new(ArenaAlloc(arena, sizeof(Declaration))) Declaration(other, arena);
+    slot->decl->SetId(nextId++);
+    count++;
+    return slot->decl;
+}
+
+
+void SymbolTable::Map(SymbolTableMapFn fn, void *clientData)
+{
+    int     n;
+
+    assert(fn != NULL);
+
+    for (n = 0; n < capacity; n++)
+        if (slots[n].decl != NULL)
+            (*fn)(slots[n].decl, clientData);
+    for (n = 0; n < dictCapacity; n++)
+        if (dictSlots[n].decl != NULL)
+            (*fn)(dictSlots[n].decl, clientData);
+}
+
+
+void SymbolTable::SetDictionary(SymbolDictionary dict)
+{
+    assert(Count() == 0 && dict != NULL);
+
+    // however big the dictionary, the table starts out as small as
+    // its own slots do
+    dictionary = dict;
+    dictCapacity = MIN_CAPACITY;
+    dictSlots = NewDictSlots(dictCapacity);
+}
+
+
+void SymbolTable::SetSpill(SymbolSpill newSpill, int firstId)
+{
+    assert(Count() == 0);
+
+    spill = newSpill;
+    nextId = firstId;
+}
+
+
+int SymbolTable::SpillAll(SymbolSpill to)
+{
+    int     n;
+
+    assert(to != NULL);
+
+    for (n = 0; n < capacity; n++)
+        if (slots[n].decl != NULL)
+            SymbolSpillStore(to, slots[n].decl);
+    for (n = 0; n < dictCapacity; n++)
+        if (dictSlots[n].decl != NULL)
+            SymbolSpillStore(to, dictSlots[n].decl);
+    return nextId;
+}
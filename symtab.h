@@ -0,0 +1,151 @@
+/*
+ * File: symtab.h
+ * --------------
+ * The SymbolTable class maps identifier names to the Declaration
+ * objects that track them.  It replaces the fixed-size chained
+ * HashTable the scanner used to keep its identifiers in.
+ *
+ * The table uses open addressing with linear probing over a flat
+ * array of slots.  Each slot caches the full hash of its name so
+ * that probes can reject mismatches without touching the string,
+ * and so that growing the table never has to rehash any names.
+ * The capacity is always a power of two and doubles whenever the
+ * table becomes more than three quarters full, which keeps lookups
+ * O(1) no matter how many identifiers are entered.
+ *
+ * Entries are numbered 0, 1, 2, ... in the order they are entered
+ * (see Declaration::GetId()).
+ *
+ * A table can be given a SymbolDictionary (see symdict.h) to look
+ * names up in first.  The Declarations of names found there are kept
+ * in DictSlots of their own rather than in the slots, open-addressed
+ * on the name's number in the dictionary, which is already a perfect
+ * hash.  They grow with the dictionary names the table has seen, not
+ * with the dictionary.  Ids are given out across both in the same
+ * order either way.
+ *
+ * A table can be given a SymbolSpill (see spill.h) to fall back on, so
+ * that it can be dropped and started over without losing any counts:
+ * names the table doesn't have are looked for in the spill before they
+ * are made new, and SpillAll() writes the table out to one first.
+ *
+ * The slot array and every Declaration the table makes live in an
+ * Arena, so dropping the table costs O(1) rather than a walk over
+ * every entry.  Slot arrays outgrown by Grow() stay in the arena
+ * until it is reset, which at most doubles the slot memory.
+ */
+
+#ifndef _H_symtab
+#define _H_symtab
+
+#include "arena.h"
+#include "utility.h"
+#include "spill.h"
+#include "symdict.h"
+
+class Declaration;
+
+typedef void (*SymbolTableMapFn)(Declaration *decl, void *clientData);
+
+class SymbolTable
+{
+  private:
+    struct Slot {
+        HashCode hash;          // decl->GetHash(), kept here so probes
+                                // don't have to follow decl
+        Declaration *decl;      // NULL if the slot is empty
+    };
+    struct DictSlot {
+        int number;             // the name's number in dictionary
+        Declaration *decl;      // NULL if the slot is empty
+    };
+
+    Slot *slots;
+    int capacity;               // number of slots, always a power of two
+    int count;                  // number of occupied slots
+    int nextId;                 // id for the next new name
+    SymbolSpill spill;          // names dropped from the table, or NULL
+    SymbolDictionary dictionary; // names looked up first, or NULL
+    DictSlot *dictSlots;        // Declarations of names in dictionary
+    int dictCapacity;           // number of dictSlots, a power of two
+    int numDictDecls;           // occupied dictSlots
+    Arena arena;                // storage for slots and Declarations
+    bool ownsArena;             // true if we made arena ourselves
+
+    Slot *NewSlots(int n);
+    Slot *FindSlot(const char *name, int length, HashCode hash);
+    DictSlot *NewDictSlots(int n);
+    DictSlot *FindDictSlot(int number);
+    int FindInDictionary(const char *name, int length, HashCode hash);
+    void EnterInDictionary(int number, Declaration *decl);
+    Declaration *NewDeclaration(const char *name, int length, HashCode hash, int lineFound);
+    void Grow();
+    void GrowDictSlots();
+
+  public:
+
+    /* Makes an empty table with room for at least sizeHint
+     * entries before it needs to grow.  Storage comes from the
+     * given arena, which must outlive the table; if it is NULL the
+     * table makes a private arena of its own. */
+    SymbolTable(int sizeHint, Arena storage = NULL);
+
+    /* Frees the table's private arena, if it has one, and with it
+     * every Declaration the table made.  Tables built on a shared
+     * arena leave their memory for that arena's next reset. */
+    ~SymbolTable();
+
+    /* Returns the number of Declarations in the table. */
+    int Count();
+
+    /* Returns the Declaration with the given name, or NULL if
+     * no such name has been entered. */
+    Declaration *Lookup(const char *name);
+
+    /* Same as above, but the name is the first length characters
+     * of name, which need not be null-terminated. */
+    Declaration *Lookup(const char *name, int length);
+
+    /* Records one occurrence of the name made of the first length
+     * characters of name and returns its Declaration.  A name seen
+     * for the first time gets a new Declaration first seen on
+     * lineFound; otherwise the existing one has its occurrence count
+     * bumped.  Only a new name allocates memory, and the name is
+     * hashed and probed once either way.  A name found in the spill
+     * comes back with the counts and id it had there, plus this
+     * occurrence. */
+    Declaration *Intern(const char *name, int length, int lineFound);
+
+    /* Adds a Declaration to the table.  The caller keeps ownership
+     * of it and must keep it alive as long as the table.  The name
+     * must not already be in the table. */
+    void Enter(Declaration *decl);
+
+    /* Folds in the counts of a Declaration from another table:
+     * if its name is already here the two are merged (see
+     * Declaration::MergeCounts()), otherwise a copy of it is made
+     * in this table's arena.  other is left untouched, and its
+     * cached hash is reused, so no name is hashed again.  Returns
+     * this table's Declaration for the name. */
+    Declaration *Merge(Declaration *other);
+
+    /* Calls fn on every Declaration in the table, in no particular
+     * order. */
+    void Map(SymbolTableMapFn fn, void *clientData);
+
+    /* Makes every lookup try dict before the table's own slots.
+     * The table must be empty, and dict must outlive it. */
+    void SetDictionary(SymbolDictionary dict);
+
+    /* Makes Intern() look a name up in spill before making it new,
+     * and numbers new names from firstId on, as if the table were
+     * carrying on from one that was spilled there. */
+    void SetSpill(SymbolSpill spill, int firstId);
+
+    /* Writes every Declaration in the table to spill, so that the
+     * table can be dropped.  Returns the id for the next new name,
+     * to pass on to the table that replaces this one. */
+    int SpillAll(SymbolSpill spill);
+};
+
+#endif
@@ -0,0 +1,752 @@
+/* File: tokencache.cc
+ * -------------------
+ * Implementation of the on-disk token cache.  See tokencache.h for
+ * comments.
+ *
+ * A hit maps the entry and checks what will be used of it before
+ * anything is replayed: the header against the source, the summary
+ * and (if the tokens are wanted) the stream against their hashes, and
+ * every offset and symbol id against the entry's bounds.  Replaying
+ * can then use the mapping as it stands, lexemes and names in place.
+ *
+ * A miss collects the pieces of the entry in growing buffers and keeps
+ * each identifier's Declaration by id, so that the symbol table stored
+ * is the scanner's own, with its final counts.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include "tokencache.h"
+#include "declaration.h"
+#include "symtab.h"
+#include "arena.h"
+
+#define DEFAULT_CACHE_SIZE  (1024L * 1024 * 1024)
+#define HASH_PIECE          (1 << 30)   // most StringHashCode() takes at once
+#define ENTRY_SUFFIX        ".pp1c"
+#define TEMP_PREFIX         ".tmp-"
+#define STALE_TEMP_AGE      3600        // seconds before a temp file is
+                                        // taken to be left by a crash
+
+static DebugChannel gCacheDebug = DebugChannelNew("cache");
+
+
+struct TokenCacheImplementation {
+    char            *directory;
+    long            maxBytes;
+};
+
+typedef struct {
+    char            *bytes;
+    size_t          size, capacity;
+} Buffer;
+
+struct CacheEntryImplementation {
+    TokenCache      cache;
+    char            *filename;          // the source
+    char            *path;              // its entry in the cache
+    ErrorHandlerFn  fn;                 // where errors go, or NULL
+    void            *clientData;
+    uint64_t        sourceHash, sourceLength;
+    struct timespec sourceTime;         // source's mtime when hashed
+    bool            found;
+
+    /* a hit: the checked mapping of the entry.  records and text are
+     * NULL if the tokens weren't wanted. */
+    char            *mapped;
+    size_t          mappedSize;
+    const TokenCacheHeader *header;
+    const CachedSymbol *symbols;
+    const TokenRecord *errors;
+    const char      *summaryText;
+    const TokenRecord *records;
+    const char      *text;
+    Arena           arena;              // Declarations made to replay
+
+    /* a miss: the pieces of the entry recorded so far */
+    Buffer          newRecords, newText, newErrors, newSummaryText;
+    Buffer          decls;              // Declaration *s, by id
+    bool            overflowed;         // too big for the format's offsets
+};
+
+static std::atomic<int> gNextTemp(0);   // tells temp files apart
+
+
+/*
+ * Function: HashMore()
+ * --------------------
+ * Folds size bytes into hash.  StringHashCode() does the work, a piece
+ * of at most HASH_PIECE bytes at a time, so a hash covers files of any
+ * size and can be built up over several regions of memory.
+ */
+static uint64_t HashMore(uint64_t hash, const void *bytes, size_t size)
+{
+    const char  *p = (const char *) bytes;
+    int         piece;
+
+    do {
+        piece = (size > HASH_PIECE ? HASH_PIECE : (int)size);
+        hash = (hash ^ StringHashCode(p, piece)) * 0x9e3779b97f4a7c15ULL;
+        p += piece;
+        size -= piece;
+    } while (size > 0);
+    return hash;
+}
+
+
+TokenCache TokenCacheNew(const char *directory, long maxBytes)
+{
+    TokenCache  cache;
+    struct stat st;
+
+    Assert(maxBytes >= 0);
+    if (mkdir(directory, 0777) < 0 && errno != EEXIST)
+        Failure("Can't make cache directory %s: %s", directory, strerror(errno));
+    if (stat(directory, &st) < 0 || !S_ISDIR(st.st_mode))
+        Failure("Can't use %s as a cache directory", directory);
+
+    cache = (TokenCache) malloc(sizeof(struct TokenCacheImplementation));
+    Assert(cache != NULL);
+    cache->directory = CopyString(directory);
+    cache->maxBytes = (maxBytes > 0 ? maxBytes : DEFAULT_CACHE_SIZE);
+    return cache;
+}
+
+
+typedef struct {
+    char            *name;
+    off_t           size;
+    time_t          lastUsed;
+} CacheFile;
+
+static int CompareLastUsed(const void *a, const void *b)
+{
+    time_t  ta = ((const CacheFile *) a)->lastUsed, tb = ((const CacheFile *) b)->lastUsed;
+
+    return (ta < tb ? -1 : ta > tb);
+}
+
+
+/*
+ * Function: Evict()
+ * -----------------
+ * Removes temp files left behind by crashed runs, and entries in order
+ * of last use until the rest fit in the cache's limit.  Files another
+ * process removes first are simply skipped.
+ */
+static void Evict(TokenCache cache)
+{
+    DIR             *dir;
+    struct dirent   *dirent;
+    struct stat     st;
+    CacheFile       *files = NULL;
+    int             numFiles = 0, maxFiles = 0, i;
+    long            total = 0;
+    size_t          nameLength;
+    char            path[PATH_MAX];
+    time_t          now = time(NULL);
+
+    if ((dir = opendir(cache->directory)) == NULL)
+        return;
+    while ((dirent = readdir(dir)) != NULL) {
+        snprintf(path, sizeof(path), "%s/%s", cache->directory, dirent->d_name);
+        if (stat(path, &st) < 0 || !S_ISREG(st.st_mode))
+            continue;
+        if (strncmp(dirent->d_name, TEMP_PREFIX, strlen(TEMP_PREFIX)) == 0) {
+            if (st.st_mtime < now - STALE_TEMP_AGE)
+                unlink(path);
+            continue;
+        }
+        nameLength = strlen(dirent->d_name);
+        if (nameLength < strlen(ENTRY_SUFFIX)
+            || strcmp(dirent->d_name + nameLength - strlen(ENTRY_SUFFIX), ENTRY_SUFFIX) != 0)
+            continue;
+
+        if (numFiles == maxFiles) {
+            maxFiles = (maxFiles > 0 ? 2 * maxFiles : 64);
+            files = (CacheFile *) realloc(files, maxFiles * sizeof(CacheFile));
+            Assert(files != NULL);
+        }
+        files[numFiles].name = CopyString(dirent->d_name);
+        files[numFiles].size = st.st_size;
+        files[numFiles].lastUsed = st.st_mtime;
+        total += st.st_size;
+        numFiles++;
+    }
+    closedir(dir);
+
+    if (total > cache->maxBytes) {
+        qsort(files, numFiles, sizeof(CacheFile), CompareLastUsed);
+        for (i = 0; i < numFiles && total > cache->maxBytes; i++) {
+            snprintf(path, sizeof(path), "%s/%s", cache->directory, files[i].name);
+            if (unlink(path) == 0)
+                DebugPrint(gCacheDebug, "evicted %s", files[i].name);
+            total -= files[i].size;
+        }
+    }
+    for (i = 0; i < numFiles; i++)
+        free(files[i].name);
+    free(files);
+}
+
+
+void TokenCacheFree(TokenCache cache)
+{
+    Assert(cache != NULL);
+
+    Evict(cache);
+    free(cache->directory);
+    free(cache);
+}
+
+
+/*
+ * Function: HashSource()
+ * ----------------------
+ * Hashes the entry's source file and notes its length and mtime.
+ */
+static void HashSource(CacheEntry entry)
+{
+    int             fd;
+    struct stat     st;
+    void            *contents;
+
+    if ((fd = open(entry->filename, O_RDONLY)) < 0)
+        Failure("Can't open %s: %s", entry->filename, strerror(errno));
+    if (fstat(fd, &st) < 0)
+        Failure("Can't stat %s: %s", entry->filename, strerror(errno));
+
+    entry->sourceLength = st.st_size;
+    entry->sourceTime = st.st_mtim;
+    entry->sourceHash = 0;
+    if (st.st_size > 0) {
+        contents = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (contents == MAP_FAILED)
+            Failure("Can't map %s: %s", entry->filename, strerror(errno));
+        entry->sourceHash = HashMore(0, contents, st.st_size);
+        munmap(contents, st.st_size);
+    }
+    close(fd);
+}
+
+
+/* Returns true if the length bytes at offset, and the '\0' after them,
+ * are within the textBytes bytes at text */
+static bool InText(const char *text, uint64_t textBytes, uint64_t offset, uint64_t length)
+{
+    return offset + length < textBytes && text[offset + length] == '\0';
+}
+
+
+/*
+ * Function: CheckSummary()
+ * ------------------------
+ * Returns true if the mapped entry is for the entry's source, is laid
+ * out as its header says, and has a whole and consistent summary.
+ */
+static bool CheckSummary(CacheEntry entry)
+{
+    const TokenCacheHeader  *header = (const TokenCacheHeader *) entry->mapped;
+    uint64_t                hash;
+    uint32_t                i;
+
+    if (entry->mappedSize < sizeof(TokenCacheHeader)
+        || memcmp(header->magic, TOKEN_CACHE_MAGIC, sizeof(header->magic)) != 0
+        || header->version != TOKEN_CACHE_VERSION
+        || header->scanner != TOKEN_CACHE_SCANNER
+        || header->sourceHash != entry->sourceHash
+        || header->sourceLength != entry->sourceLength
+        || header->summaryTextBytes % 8 != 0
+        || entry->mappedSize != sizeof(TokenCacheHeader)
+                                + (uint64_t)header->numSymbols * sizeof(CachedSymbol)
+                                + (uint64_t)header->numErrors * sizeof(TokenRecord)
+                                + header->summaryTextBytes
+                                + header->numRecords * sizeof(TokenRecord)
+                                + header->textBytes)
+        return false;
+
+    entry->header = header;
+    entry->symbols = (const CachedSymbol *) (header + 1);
+    entry->errors = (const TokenRecord *) (entry->symbols + header->numSymbols);
+    entry->summaryText = (const char *) (entry->errors + header->numErrors);
+
+    hash = HashMore(0, entry->symbols, header->numSymbols * sizeof(CachedSymbol));
+    hash = HashMore(hash, entry->errors, header->numErrors * sizeof(TokenRecord));
+    hash = HashMore(hash, entry->summaryText, header->summaryTextBytes);
+    if (hash != header->summaryHash)
+        return false;
+
+    for (i = 0; i < header->numSymbols; i++)
+        if (!InText(entry->summaryText, header->summaryTextBytes,
+                    entry->symbols[i].nameOffset, entry->symbols[i].nameLength)
+            || entry->symbols[i].nameLength == 0 || entry->symbols[i].numOccurrences <= 0)
+            return false;
+    for (i = 0; i < header->numErrors; i++)
+        if (entry->errors[i].type != TOKEN_ERROR
+            || !InText(entry->summaryText, header->summaryTextBytes,
+                       entry->errors[i].textOffset, entry->errors[i].textLength))
+            return false;
+    return true;
+}
+
+
+/*
+ * Function: CheckStream()
+ * -----------------------
+ * Returns true if the entry's stream, which follows its checked
+ * summary, is whole and consistent.
+ */
+static bool CheckStream(CacheEntry entry)
+{
+    const TokenCacheHeader  *header = entry->header;
+    const TokenRecord       *records;
+    const char              *text;
+    uint64_t                i;
+    uint32_t                numSeen = 0;
+
+    records = (const TokenRecord *) (entry->summaryText + header->summaryTextBytes);
+    text = (const char *) (records + header->numRecords);
+    if (HashMore(HashMore(0, records, header->numRecords * sizeof(TokenRecord)),
+                 text, header->textBytes) != header->streamHash)
+        return false;
+
+    // identifiers get their ids in order of first appearance
+    for (i = 0; i < header->numRecords; i++) {
+        if (!InText(text, header->textBytes, records[i].textOffset, records[i].textLength))
+            return false;
+        if (records[i].type == T_Identifier) {
+            if (records[i].value.symbolId < 0 || (uint32_t)records[i].value.symbolId > numSeen
+                || (uint32_t)records[i].value.symbolId >= header->numSymbols)
+                return false;
+            if ((uint32_t)records[i].value.symbolId == numSeen)
+                numSeen++;
+        }
+    }
+    if (numSeen != header->numSymbols)
+        return false;
+
+    entry->records = records;
+    entry->text = text;
+    return true;
+}
+
+
+/*
+ * Function: MapEntry()
+ * --------------------
+ * Maps the cache's entry for the source and checks as much of it as
+ * is wanted.  Returns false if there is none, or none worth using; a
+ * bad one is removed so that it gets replaced.  Only the pages that
+ * are checked are read in, so a summary costs the same however big
+ * the source is.
+ */
+static bool MapEntry(CacheEntry entry, bool wantTokens)
+{
+    int             fd;
+    struct stat     st;
+
+    if ((fd = open(entry->path, O_RDONLY)) < 0)
+        return false;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return false;
+    }
+    entry->mappedSize = st.st_size;
+    entry->mapped = (char *) mmap(NULL, entry->mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (entry->mapped == MAP_FAILED) {
+        entry->mapped = NULL;
+        close(fd);
+        unlink(entry->path);
+        return false;
+    }
+    if (!CheckSummary(entry) || (wantTokens && !CheckStream(entry))) {
+        DebugPrint(gCacheDebug, "%s has a bad entry", entry->filename);
+        munmap(entry->mapped, entry->mappedSize);
+        entry->mapped = NULL;
+        close(fd);
+        unlink(entry->path);
+        return false;
+    }
+
+    // mark it used, for eviction
+    futimens(fd, NULL);
+    close(fd);
+    return true;
+}
+
+
+CacheEntry CacheEntryOpen(TokenCache cache, const char *filename, bool wantTokens,
+                          ErrorHandlerFn fn, void *clientData)
+{
+    CacheEntry  entry;
+    char        name[64];
+
+    Assert(cache != NULL && filename != NULL);
+
+    entry = (CacheEntry) calloc(1, sizeof(struct CacheEntryImplementation));
+    Assert(entry != NULL);
+    entry->cache = cache;
+    entry->filename = CopyString(filename);
+    entry->fn = fn;
+    entry->clientData = clientData;
+
+    HashSource(entry);
+    snprintf(name, sizeof(name), "%016" PRIx64 "-%" PRIx64 "-%d" ENTRY_SUFFIX,
+             entry->sourceHash, entry->sourceLength, TOKEN_CACHE_SCANNER);
+    entry->path = (char *) malloc(strlen(cache->directory) + 1 + strlen(name) + 1);
+    Assert(entry->path != NULL);
+    sprintf(entry->path, "%s/%s", cache->directory, name);
+
+    entry->found = MapEntry(entry, wantTokens);
+    DebugPrint(gCacheDebug, "%s %s", entry->found ? "hit" : "miss", filename);
+    return entry;
+}
+
+
+bool CacheEntryFound(CacheEntry entry)
+{
+    Assert(entry != NULL);
+    return entry->found;
+}
+
+
+/* Hands an error to the entry's handler, or prints it */
+static void PassOn(CacheEntry entry, struct yyltype *pos, const char *message)
+{
+    if (entry->fn != NULL)
+        entry->fn(pos, message, entry->clientData);
+    else
+        PrintError(pos, message);
+}
+
+
+/* Replays an error record whose message is in text */
+static void ReplayError(CacheEntry entry, const TokenRecord *record, const char *text)
+{
+    struct yyltype  loc;
+
+    loc.first_line = record->line;
+    loc.first_column = record->firstColumn;
+    loc.last_column = record->lastColumn;
+    PassOn(entry, record->value.hasPosition ? &loc : NULL, text + record->textOffset);
+}
+
+
+/*
+ * Function: NewSymbol()
+ * ---------------------
+ * Makes a Declaration, in the entry's arena, for cached symbol id.
+ */
+static Declaration *NewSymbol(CacheEntry entry, int id, int lineFound)
+{
+    const CachedSymbol  *symbol = &entry->symbols[id];
+    const char          *name = entry->summaryText + symbol->nameOffset;
+    Declaration         *decl;
+
+    if (entry->arena == NULL)
+        entry->arena = ArenaNew(0);
+    decl = new(ArenaAlloc(entry->arena, sizeof(Declaration)))
+        Declaration(name, symbol->nameLength, StringHashCode(name, symbol->nameLength),
+                    lineFound, entry->arena);
+    decl->SetId(id);
+    return decl;
+}
+
+
+void CacheEntryReplay(CacheEntry entry, TokenWriter writer)
+{
+    const TokenRecord   *record;
+    Declaration         **decls;
+    YYSTYPE             value;
+    yyltype             loc;
+    char                *text;
+    uint64_t            i;
+    int                 numSeen = 0;
+
+    Assert(entry != NULL && entry->found && entry->records != NULL);
+
+    // identifiers are counted as they go by, as the scanner counts
+    // them, so each one prints with its count so far
+    decls = NULL;
+    if (entry->header->numSymbols > 0) {
+        decls = (Declaration **) malloc(entry->header->numSymbols * sizeof(Declaration *));
+        Assert(decls != NULL);
+    }
+
+    for (i = 0; i < entry->header->numRecords; i++) {
+        record = &entry->records[i];
+        if (record->type == TOKEN_ERROR) {
+            ReplayError(entry, record, entry->text);
+            continue;
+        }
+
+        loc.first_line = record->line;
+        loc.first_column = record->firstColumn;
+        loc.last_column = record->lastColumn;
+        text = (char *) entry->text + record->textOffset;
+        switch (record->type) {
+          case T_IntConstant:
+            value.integerConstant = record->value.integerConstant; break;
+          case T_DoubleConstant:
+            value.doubleConstant = record->value.doubleConstant; break;
+          case T_BoolConstant:
+            value.boolConstant = record->value.boolConstant; break;
+          case T_StringConstant:
+            value.stringConstant.chars = text;
+            value.stringConstant.length = record->textLength;
+            break;
+          case T_Identifier:
+            if (record->value.symbolId == numSeen) {
+                decls[numSeen] = NewSymbol(entry, numSeen, record->line);
+                numSeen++;
+            } else {
+                decls[record->value.symbolId]->IncrementOccurrences();
+            }
+            value.decl = decls[record->value.symbolId];
+            break;
+        }
+        if (writer != NULL)
+            TokenWriterAppend(writer, (TokenType)record->type, text, record->textLength, value, loc);
+        else
+            PrintOneToken((TokenType)record->type, text, value, loc);
+    }
+    free(decls);
+}
+
+
+void CacheEntryMergeSymbols(CacheEntry entry, SymbolTableMapFn fn, void *clientData)
+{
+    const CachedSymbol  *symbol;
+    Declaration         *decl;
+    uint32_t            i;
+
+    Assert(entry != NULL && entry->found);
+
+    for (i = 0; i < entry->header->numErrors; i++)
+        ReplayError(entry, &entry->errors[i], entry->summaryText);
+
+    for (i = 0; i < entry->header->numSymbols; i++) {
+        symbol = &entry->symbols[i];
+        decl = NewSymbol(entry, i, symbol->firstLine);
+        decl->SetOccurrences(symbol->numOccurrences);
+        (*fn)(decl, clientData);
+    }
+}
+
+
+/* Makes room for size more bytes at the end of buffer and returns
+ * where they go */
+static void *BufferGrow(Buffer *buffer, size_t size)
+{
+    void    *end;
+
+    if (buffer->size + size > buffer->capacity) {
+        buffer->capacity = (buffer->capacity > 0 ? 2 * buffer->capacity : 16384);
+        if (buffer->capacity < buffer->size + size)
+            buffer->capacity = buffer->size + size;
+        buffer->bytes = (char *) realloc(buffer->bytes, buffer->capacity);
+        Assert(buffer->bytes != NULL);
+    }
+    end = buffer->bytes + buffer->size;
+    buffer->size += size;
+    return end;
+}
+
+
+/* Adds length bytes of text and a '\0' to a miss's text buffer, and
+ * returns their offset */
+static uint32_t AppendText(CacheEntry entry, Buffer *text, const char *chars, int length)
+{
+    size_t      offset = text->size;
+    char        *copy = (char *) BufferGrow(text, length + 1);
+
+    memcpy(copy, chars, length);
+    copy[length] = '\0';
+    if (text->size > UINT32_MAX)
+        entry->overflowed = true;
+    return offset;
+}
+
+
+/* Adds a record to a miss's stream, with a copy of its text */
+static TokenRecord *NewRecord(CacheEntry entry, const char *text, int length)
+{
+    TokenRecord     *record;
+    uint32_t        offset = AppendText(entry, &entry->newText, text, length);
+
+    record = (TokenRecord *) BufferGrow(&entry->newRecords, sizeof(TokenRecord));
+    record->textOffset = offset;
+    record->textLength = length;
+    return record;
+}
+
+
+void CacheEntryAppend(CacheEntry entry, TokenType token, const char *text,
+                      int length, YYSTYPE value, yyltype loc)
+{
+    TokenRecord     *record;
+    int             numDecls;
+
+    Assert(entry != NULL && !entry->found);
+    numDecls = entry->decls.size / sizeof(Declaration *);
+
+    record = NewRecord(entry, text, length);
+    record->type = token;
+    record->line = loc.first_line;
+    record->firstColumn = loc.first_column;
+    record->lastColumn = loc.last_column;
+    record->value.doubleConstant = 0;
+
+    switch (token) {
+      case T_IntConstant:
+        record->value.integerConstant = value.integerConstant; break;
+      case T_DoubleConstant:
+        record->value.doubleConstant = value.doubleConstant; break;
+      case T_BoolConstant:
+        record->value.boolConstant = value.boolConstant; break;
+      case T_Identifier:
+        record->value.symbolId = value.decl->GetId();
+        Assert(record->value.symbolId >= 0 && record->value.symbolId <= numDecls);
+        if (record->value.symbolId == numDecls)
+            *(Declaration **) BufferGrow(&entry->decls, sizeof(Declaration *)) = value.decl;
+        break;
+      default:
+        break;  // string constants are their own lexeme
+    }
+}
+
+
+void CacheEntryAppendError(struct yyltype *pos, const char *message, void *clientData)
+{
+    CacheEntry      entry = (CacheEntry) clientData;
+    TokenRecord     *record, *summary;
+    int             length = strlen(message);
+
+    Assert(entry != NULL && !entry->found);
+
+    // in the stream, in order, and in the summary
+    record = NewRecord(entry, message, length);
+    record->type = TOKEN_ERROR;
+    record->line = pos ? pos->first_line : 0;
+    record->firstColumn = pos ? pos->first_column : 0;
+    record->lastColumn = pos ? pos->last_column : 0;
+    record->value.doubleConstant = 0;
+    record->value.hasPosition = (pos != NULL);
+
+    summary = (TokenRecord *) BufferGrow(&entry->newErrors, sizeof(TokenRecord));
+    *summary = *record;
+    summary->textOffset = AppendText(entry, &entry->newSummaryText, message, length);
+
+    PassOn(entry, pos, message);
+}
+
+
+void CacheEntryStore(CacheEntry entry)
+{
+    TokenCacheHeader    header;
+    Buffer              symbols = {NULL, 0, 0};
+    CachedSymbol        *symbol;
+    Declaration         **decls;
+    struct stat         st;
+    char                *temp;
+    size_t              padding;
+    int                 fd, i, numDecls;
+    bool                written;
+
+    Assert(entry != NULL);
+    if (entry->found)
+        return;
+
+    // a file edited while it was scanned may not match its hash
+    if (stat(entry->filename, &st) < 0 || (uint64_t)st.st_size != entry->sourceLength
+        || st.st_mtim.tv_sec != entry->sourceTime.tv_sec
+        || st.st_mtim.tv_nsec != entry->sourceTime.tv_nsec)
+        return;
+
+    // the names go in the summary text after the error messages
+    decls = (Declaration **) entry->decls.bytes;
+    numDecls = entry->decls.size / sizeof(Declaration *);
+    for (i = 0; i < numDecls; i++) {
+        symbol = (CachedSymbol *) BufferGrow(&symbols, sizeof(CachedSymbol));
+        symbol->nameOffset = AppendText(entry, &entry->newSummaryText,
+                                        decls[i]->GetName(), decls[i]->GetLength());
+        symbol->nameLength = decls[i]->GetLength();
+        symbol->firstLine = decls[i]->GetFirstLine();
+        symbol->numOccurrences = decls[i]->GetOccurrences();
+    }
+    padding = (8 - entry->newSummaryText.size % 8) % 8;
+    if (padding > 0)
+        memset(BufferGrow(&entry->newSummaryText, padding), 0, padding);
+    if (entry->overflowed) {
+        free(symbols.bytes);
+        return;
+    }
+
+    memcpy(header.magic, TOKEN_CACHE_MAGIC, sizeof(header.magic));
+    header.version = TOKEN_CACHE_VERSION;
+    header.scanner = TOKEN_CACHE_SCANNER;
+    header.unused = 0;
+    header.sourceHash = entry->sourceHash;
+    header.sourceLength = entry->sourceLength;
+    header.numSymbols = numDecls;
+    header.numErrors = entry->newErrors.size / sizeof(TokenRecord);
+    header.summaryTextBytes = entry->newSummaryText.size;
+    header.numRecords = entry->newRecords.size / sizeof(TokenRecord);
+    header.textBytes = entry->newText.size;
+    header.summaryHash = HashMore(0, symbols.bytes, symbols.size);
+    header.summaryHash = HashMore(header.summaryHash, entry->newErrors.bytes, entry->newErrors.size);
+    header.summaryHash = HashMore(header.summaryHash, entry->newSummaryText.bytes,
+                                  entry->newSummaryText.size);
+    header.streamHash = HashMore(0, entry->newRecords.bytes, entry->newRecords.size);
+    header.streamHash = HashMore(header.streamHash, entry->newText.bytes, entry->newText.size);
+
+    temp = (char *) malloc(strlen(entry->cache->directory) + 64);
+    Assert(temp != NULL);
+    sprintf(temp, "%s/" TEMP_PREFIX "%d-%d", entry->cache->directory, (int)getpid(), gNextTemp++);
+    if ((fd = open(temp, O_WRONLY | O_CREAT | O_EXCL, 0644)) >= 0) {
+        written = WriteAll(fd, &header, sizeof(header))
+                  && WriteAll(fd, symbols.bytes, symbols.size)
+                  && WriteAll(fd, entry->newErrors.bytes, entry->newErrors.size)
+                  && WriteAll(fd, entry->newSummaryText.bytes, entry->newSummaryText.size)
+                  && WriteAll(fd, entry->newRecords.bytes, entry->newRecords.size)
+                  && WriteAll(fd, entry->newText.bytes, entry->newText.size);
+        close(fd);
+        if (written && rename(temp, entry->path) == 0)
+            DebugPrint(gCacheDebug, "stored %s", entry->filename);
+        else
+            unlink(temp);
+    }
+    free(temp);
+    free(symbols.bytes);
+}
+
+
+void CacheEntryFree(CacheEntry entry)
+{
+    Assert(entry != NULL);
+
+    if (entry->mapped != NULL)
+        munmap(entry->mapped, entry->mappedSize);
+    if (entry->arena != NULL)
+        ArenaFree(entry->arena);
+    free(entry->newRecords.bytes);
+    free(entry->newText.bytes);
+    free(entry->newErrors.bytes);
+    free(entry->newSummaryText.bytes);
+    free(entry->decls.bytes);
+    free(entry->filename);
+    free(entry->path);
+    free(entry);
+}
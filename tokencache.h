@@ -0,0 +1,181 @@
+/*
+ * File: tokencache.h
+ * ------------------
+ * A cache of scans on disk, so a file that hasn't changed since it
+ * was last scanned isn't scanned again.  pp1 -c <directory> looks each
+ * input file up by a hash of its contents; on a hit it maps the entry
+ * stored there and replays its tokens, errors and symbol table instead
+ * of running the scanner, and on a miss it records the scan as it goes
+ * and stores it for next time.
+ *
+ * An entry is one file in the cache directory, named for the source's
+ * hash and length and the TOKEN_CACHE_SCANNER it was scanned by.  After
+ * its TokenCacheHeader comes a summary of the scan: the symbol table as
+ * CachedSymbols in order of id, the errors as TokenRecords of type
+ * TOKEN_ERROR (see tokenstream.h), and the identifier names and error
+ * messages they point to.  Then comes the whole stream: the tokens and
+ * errors, in order, as TokenRecords, and their lexemes and
+ * messages.  Each piece of text is followed by a '\0' so that it can be
+ * used in place, and the summary's text is padded to a multiple of 8
+ * bytes.  Numbers are in the writer's native byte order.
+ *
+ * The multi-file driver only needs the summary, which is small, so that
+ * is all it reads or checks.  An entry whose version, scanner, hash or
+ * layout is wrong, or whose summary or stream doesn't match the hash in
+ * its header (e.g. one cut off by a crash), is treated as a miss and
+ * replaced.
+ *
+ * An entry is written to a temporary file in the directory and then
+ * renamed into place, so other pp1s scanning at the same time see all
+ * of it or none.  Every hit touches the entry's modification time.
+ * When the cache is freed, the entries used longest ago are removed
+ * until the directory is back under its size limit.
+ */
+
+#ifndef _H_tokencache
+#define _H_tokencache
+
+#include <stdint.h>
+#include "tokenstream.h"
+#include "symtab.h"
+#include "utility.h"
+
+#define TOKEN_CACHE_MAGIC       "PP1C"
+#define TOKEN_CACHE_VERSION     1
+
+/*
+ * TOKEN_CACHE_SCANNER numbers what the scanner makes of a source: its
+ * tokens, values, positions and error messages.  Bump it whenever any
+ * of them change, so that entries scanned before are no longer found.
+ *    1: the first cached scans
+ *    2: integer and double constants out of range are errors
+ */
+#define TOKEN_CACHE_SCANNER     2
+
+typedef struct {
+    char        magic[4];           // TOKEN_CACHE_MAGIC
+    uint32_t    version;            // TOKEN_CACHE_VERSION
+    uint32_t    scanner;            // TOKEN_CACHE_SCANNER
+    uint32_t    unused;
+    uint64_t    sourceHash;         // hash of the source's contents
+    uint64_t    sourceLength;       // length of the source
+    uint64_t    summaryHash;        // hash of the summary
+    uint64_t    streamHash;         // hash of the stream
+    uint32_t    numSymbols;         // CachedSymbols in the summary
+    uint32_t    numErrors;          // TokenRecords in the summary
+    uint64_t    summaryTextBytes;   // summary text, with its padding
+    uint64_t    numRecords;         // TokenRecords in the stream
+    uint64_t    textBytes;          // stream text
+} TokenCacheHeader;
+
+typedef struct {
+    uint32_t    nameOffset;         // name's offset in the summary text
+    uint32_t    nameLength;
+    int32_t     firstLine;          // Declaration's first line
+    int32_t     numOccurrences;     // and count after the whole file
+} CachedSymbol;
+
+
+typedef struct TokenCacheImplementation *TokenCache;
+
+/*
+ * Function: TokenCacheNew()
+ * Usage: cache = TokenCacheNew(".pp1cache", 0);
+ * ---------------------------------------------
+ * Opens the cache in the given directory, making the directory if it
+ * doesn't exist yet.  maxBytes bounds the size of the entries kept
+ * there (0 picks a default).  One cache can be used by several threads
+ * at once.
+ */
+TokenCache TokenCacheNew(const char *directory, long maxBytes);
+
+/*
+ * Function: TokenCacheFree()
+ * --------------------------
+ * Removes the least recently used entries until the cache is no bigger
+ * than its limit, and frees the cache.
+ */
+void TokenCacheFree(TokenCache cache);
+
+
+typedef struct CacheEntryImplementation *CacheEntry;
+
+/*
+ * Function: CacheEntryOpen()
+ * Usage: entry = CacheEntryOpen(cache, "program.decaf", true, NULL, NULL);
+ * ------------------------------------------------------------------------
+ * Hashes the named file and looks it up in the cache.  wantTokens says
+ * whether the entry will be replayed, or only have its symbols merged,
+ * which doesn't need the stream to be read.  Errors that are replayed
+ * from the entry, or recorded into it, are passed on to fn with the
+ * given clientData, or printed with PrintError() if fn is NULL.
+ */
+CacheEntry CacheEntryOpen(TokenCache cache, const char *filename, bool wantTokens,
+                          ErrorHandlerFn fn, void *clientData);
+
+/*
+ * Function: CacheEntryFound()
+ * ---------------------------
+ * Returns true if the cache has a scan of the file, which can then be
+ * replayed, or false if the file has to be scanned and recorded.
+ */
+bool CacheEntryFound(CacheEntry entry);
+
+/*
+ * Function: CacheEntryReplay()
+ * Usage: CacheEntryReplay(entry, NULL);
+ * -------------------------------------
+ * Prints the cached tokens and errors exactly as pp1 would print them
+ * if it scanned the file, or adds them to writer if it isn't NULL.
+ * The entry must have been opened wanting tokens.
+ */
+void CacheEntryReplay(CacheEntry entry, TokenWriter writer);
+
+/*
+ * Function: CacheEntryMergeSymbols()
+ * ----------------------------------
+ * Passes on the cached errors and calls fn on a Declaration for each
+ * of the file's identifiers, with its counts and first line, for fn to
+ * fold into the caller's totals, which is all the multi-file driver
+ * needs of a file.
+ */
+void CacheEntryMergeSymbols(CacheEntry entry, SymbolTableMapFn fn, void *clientData);
+
+/*
+ * Function: CacheEntryAppend()
+ * Usage: CacheEntryAppend(entry, token, yytext, yyleng, yylval, yylloc);
+ * ----------------------------------------------------------------------
+ * Records one token of a file that wasn't found.  An identifier's
+ * Declaration must stay alive until CacheEntryStore().
+ */
+void CacheEntryAppend(CacheEntry entry, TokenType token, const char *text,
+                      int length, YYSTYPE value, yyltype loc);
+
+/*
+ * Function: CacheEntryAppendError()
+ * ---------------------------------
+ * Records an error reported while scanning a file that wasn't found,
+ * and passes it on.  Intended for use as an ErrorHandlerFn with the
+ * entry as its client data.
+ */
+void CacheEntryAppendError(struct yyltype *pos, const char *message, void *entry);
+
+/*
+ * Function: CacheEntryStore()
+ * ---------------------------
+ * Writes what has been recorded to the cache, with the symbol table
+ * as it stands now.  Call it once the whole file has been scanned.
+ * Nothing is stored if the file changed since CacheEntryOpen(), and a
+ * cache that can't be written to is skipped rather than being an
+ * error.
+ */
+void CacheEntryStore(CacheEntry entry);
+
+/*
+ * Function: CacheEntryFree()
+ * --------------------------
+ * Unmaps or frees whatever the entry holds.
+ */
+void CacheEntryFree(CacheEntry entry);
+
+#endif
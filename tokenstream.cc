@@ -0,0 +1,369 @@
+/* File: tokenstream.cc
+ * --------------------
+ * Implementation of the text and binary token output formats.
+ * See tokenstream.h for comments.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "tokenstream.h"
+#include "declaration.h"
+#include "utility.h"
+
+#define DEFAULT_BUFFER_SIZE (1024 * 1024)
+
+
+/*
+ * Function: PrintOneToken()
+ * Usage: PrintOneToken(T_Double, "3.5", val, loc);
+ * -----------------------------------------------
+ * We supply this function to print information about the tokens returned
+ * by the lexer as part of pp1.  Do not modifiy it.
+ */
+void PrintOneToken(TokenType token, char *text, YYSTYPE value, yyltype loc)
+{
+  char buffer[] = {'\'', token, '\'', '\0'};
+  const char *name = token >= T_Void ? gTokenNames[token - T_Void] : buffer;
+  
+  printf("%-12s line %d cols %d-%d is %s ", text,
+	   loc.first_line, loc.first_column, loc.last_column, name);
+  
+  switch(token) {
+    case T_IntConstant:     
+      printf("(value = %d)\n", value.integerConstant); break;
+    case T_DoubleConstant:   
+      printf("(value = %g)\n", value.doubleConstant); break;
+    case T_StringConstant:  
+      printf("(value = %.*s)\n", value.stringConstant.length, value.stringConstant.chars); break;
+    case T_BoolConstant:    
+      printf("(value = %s)\n", value.boolConstant ? "true" : "false"); break;
+    case T_Identifier: 
+      value.decl->Print(); break;
+    default:
+      printf("\n"); break;
+  }
+}
+
+
+/*
+ * The writer keeps one buffer split into two regions: the block header
+ * and its records at the front, the block's text after them.  When
+ * either region fills up, both go out with a single writev.
+ */
+
+struct TokenWriterImplementation {
+    int                 fd;             // where the stream goes
+    char                *buffer;        // header + records, then text
+    int                 maxRecords;     // record slots in the buffer
+    int                 textCapacity;   // text bytes in the buffer
+    TokenBlockHeader    *block;         // start of buffer
+    TokenRecord         *records;       // record slots
+    char                *text;          // text region
+    char                *ownText;       // text region once it outgrows
+                                        // buffer, else NULL
+};
+
+
+static void WriteFully(int fd, struct iovec *iov, int iovcnt)
+{
+    ssize_t     written;
+
+    // writev may stop short on pipes, so keep going until every
+    // iovec has been consumed
+
+    while (iovcnt > 0) {
+        written = writev(fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            Failure("Can't write token stream: %s", strerror(errno));
+        }
+        while (iovcnt > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
+
+static void TokenWriterFlush(TokenWriter writer)
+{
+    struct iovec    iov[2];
+
+    if (writer->block->numRecords == 0)
+        return;
+
+    iov[0].iov_base = writer->block;
+    iov[0].iov_len = sizeof(TokenBlockHeader) + writer->block->numRecords * sizeof(TokenRecord);
+    iov[1].iov_base = writer->text;
+    iov[1].iov_len = writer->block->textBytes;
+    WriteFully(writer->fd, iov, 2);
+
+    writer->block->numRecords = 0;
+    writer->block->textBytes = 0;
+}
+
+
+TokenWriter TokenWriterNew(int fd, int bufferSize)
+{
+    TokenWriter         writer;
+    TokenStreamHeader   header;
+    struct iovec        iov;
+
+    assert(bufferSize >= 0);
+    if (bufferSize == 0)
+        bufferSize = DEFAULT_BUFFER_SIZE;
+
+    writer = (TokenWriter) malloc(sizeof(struct TokenWriterImplementation));
+    Assert(writer != NULL);
+
+    // split the buffer so a block of average-length lexemes fills
+    // both regions at about the same time
+
+    writer->fd = fd;
+    writer->maxRecords = (bufferSize / 2 - sizeof(TokenBlockHeader)) / sizeof(TokenRecord);
+    assert(writer->maxRecords > 0);
+    writer->textCapacity = bufferSize - bufferSize / 2;
+    writer->buffer = (char *) malloc(bufferSize);
+    Assert(writer->buffer != NULL);
+    writer->block = (TokenBlockHeader *) writer->buffer;
+    writer->records = (TokenRecord *) (writer->block + 1);
+    writer->text = writer->buffer + bufferSize / 2;
+    writer->ownText = NULL;
+    writer->block->numRecords = 0;
+    writer->block->textBytes = 0;
+
+    memcpy(header.magic, TOKEN_STREAM_MAGIC, sizeof(header.magic));
+    header.version = TOKEN_STREAM_VERSION;
+    iov.iov_base = &header;
+    iov.iov_len = sizeof(header);
+    WriteFully(fd, &iov, 1);
+
+    return writer;
+}
+
+
+static TokenRecord *TokenWriterNewRecord(TokenWriter writer, const char *text, int length)
+{
+    TokenRecord     *record;
+
+    assert(length >= 0);
+
+    // start a new block when this record or its text won't fit.  A
+    // lexeme longer than the whole text region gets a region of its
+    // own size.
+
+    if (writer->block->numRecords == writer->maxRecords
+        || writer->block->textBytes + length > writer->textCapacity)
+        TokenWriterFlush(writer);
+    if (length > writer->textCapacity) {
+        free(writer->ownText);
+        writer->ownText = writer->text = (char *) malloc(length);
+        Assert(writer->text != NULL);
+        writer->textCapacity = length;
+    }
+
+    record = &writer->records[writer->block->numRecords++];
+    record->textOffset = writer->block->textBytes;
+    record->textLength = length;
+    memcpy(writer->text + writer->block->textBytes, text, length);
+    writer->block->textBytes += length;
+    return record;
+}
+
+
+void TokenWriterAppend(TokenWriter writer, TokenType token, const char *text,
+                       int length, YYSTYPE value, yyltype loc)
+{
+    TokenRecord     *record;
+
+    assert(writer != NULL);
+
+    record = TokenWriterNewRecord(writer, text, length);
+    record->type = token;
+    record->line = loc.first_line;
+    record->firstColumn = loc.first_column;
+    record->lastColumn = loc.last_column;
+    record->value.doubleConstant = 0;
+
+    switch (token) {
+      case T_IntConstant:
+        record->value.integerConstant = value.integerConstant; break;
+      case T_DoubleConstant:
+        record->value.doubleConstant = value.doubleConstant; break;
+      case T_BoolConstant:
+        record->value.boolConstant = value.boolConstant; break;
+      case T_Identifier:
+        record->value.symbolId = value.decl->GetId(); break;
+      default:
+        break;  // string constants are their own lexeme
+    }
+}
+
+
+void TokenWriterAppendError(struct yyltype *pos, const char *message, void *clientData)
+{
+    TokenWriter     writer = (TokenWriter) clientData;
+    TokenRecord     *record;
+
+    assert(writer != NULL);
+
+    record = TokenWriterNewRecord(writer, message, strlen(message));
+    record->type = TOKEN_ERROR;
+    record->line = pos ? pos->first_line : 0;
+    record->firstColumn = pos ? pos->first_column : 0;
+    record->lastColumn = pos ? pos->last_column : 0;
+    record->value.doubleConstant = 0;
+    record->value.hasPosition = (pos != NULL);
+}
+
+
+void TokenWriterFree(TokenWriter writer)
+{
+    assert(writer != NULL);
+
+    TokenWriterFlush(writer);
+    free(writer->ownText);
+    free(writer->buffer);
+    free(writer);
+}
+
+
+/*
+ * The reader pulls in one whole block at a time and hands out its
+ * records in order.  Lexemes are copied out one at a time so they
+ * can be null-terminated.
+ */
+
+struct TokenReaderImplementation {
+    int                 fd;             // where the stream comes from
+    TokenBlockHeader    block;          // header of the current block
+    int                 next;           // index of the next record
+    TokenRecord         *records;       // the current block's records
+    char                *text;          // the current block's text
+    int                 maxRecords;     // allocated size of records
+    int                 textCapacity;   // allocated size of text
+    char                *lexeme;        // null-terminated current lexeme
+    int                 lexemeCapacity; // allocated size of lexeme
+};
+
+
+/* Reads exactly size bytes.  Returns false on a clean end of file
+ * before the first byte, fails on a stream cut off in the middle. */
+static bool ReadFully(int fd, void *buf, size_t size)
+{
+    size_t      got = 0;
+    ssize_t     n;
+
+    while (got < size) {
+        n = read(fd, (char *)buf + got, size - got);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+            Failure("Can't read token stream: %s", strerror(errno));
+        if (n == 0) {
+            if (got == 0)
+                return false;
+            Failure("Token stream is truncated");
+        }
+        got += n;
+    }
+    return true;
+}
+
+
+TokenReader TokenReaderNew(int fd)
+{
+    TokenReader         reader;
+    TokenStreamHeader   header;
+
+    if (!ReadFully(fd, &header, sizeof(header))
+        || memcmp(header.magic, TOKEN_STREAM_MAGIC, sizeof(header.magic)) != 0)
+        Failure("Input is not a pp1 token stream");
+    if (header.version != TOKEN_STREAM_VERSION)
+        Failure("Token stream is version %u, expected %u", header.version, TOKEN_STREAM_VERSION);
+
+    reader = (TokenReader) malloc(sizeof(struct TokenReaderImplementation));
+    Assert(reader != NULL);
+    reader->fd = fd;
+    reader->block.numRecords = 0;
+    reader->block.textBytes = 0;
+    reader->next = 0;
+    reader->records = NULL;
+    reader->text = NULL;
+    reader->lexeme = NULL;
+    reader->maxRecords = reader->textCapacity = reader->lexemeCapacity = 0;
+    return reader;
+}
+
+
+static bool TokenReaderNextBlock(TokenReader reader)
+{
+    TokenBlockHeader    *block = &reader->block;
+
+    if (!ReadFully(reader->fd, block, sizeof(*block)))
+        return false;
+
+    if (block->numRecords > reader->maxRecords) {
+        reader->maxRecords = block->numRecords;
+        reader->records = (TokenRecord *) realloc(reader->records, reader->maxRecords * sizeof(TokenRecord));
+        Assert(reader->records != NULL);
+    }
+    if (block->textBytes > reader->textCapacity) {
+        reader->textCapacity = block->textBytes;
+        reader->text = (char *) realloc(reader->text, reader->textCapacity);
+        Assert(reader->text != NULL);
+    }
+    if (!ReadFully(reader->fd, reader->records, block->numRecords * sizeof(TokenRecord))
+        || !ReadFully(reader->fd, reader->text, block->textBytes))
+        Failure("Token stream is truncated");
+
+    reader->next = 0;
+    return true;
+}
+
+
+bool TokenReaderNext(TokenReader reader, TokenRecord *record, char **text)
+{
+    assert(reader != NULL);
+
+    // skip ahead to the next block with something in it
+
+    while (reader->next == reader->block.numRecords)
+        if (!TokenReaderNextBlock(reader))
+            return false;
+
+    *record = reader->records[reader->next++];
+    if (record->textOffset + record->textLength > reader->block.textBytes)
+        Failure("Token stream has a bad lexeme offset");
+
+    if (record->textLength + 1 > reader->lexemeCapacity) {
+        reader->lexemeCapacity = record->textLength + 1;
+        reader->lexeme = (char *) realloc(reader->lexeme, reader->lexemeCapacity);
+        Assert(reader->lexeme != NULL);
+    }
+    memcpy(reader->lexeme, reader->text + record->textOffset, record->textLength);
+    reader->lexeme[record->textLength] = '\0';
+    *text = reader->lexeme;
+    return true;
+}
+
+
+void TokenReaderFree(TokenReader reader)
+{
+    assert(reader != NULL);
+
+    free(reader->records);
+    free(reader->text);
+    free(reader->lexeme);
+    free(reader);
+}
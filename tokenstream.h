@@ -0,0 +1,132 @@
+/*
+ * File: tokenstream.h
+ * -------------------
+ * Output of scanned tokens.  PrintOneToken() is the text format pp1
+ * has always printed.  A TokenWriter produces the compact binary
+ * format selected with pp1 -b, and a TokenReader reads it back (see
+ * the pp1decode tool, which turns a binary stream into the text
+ * format).
+ *
+ * A binary stream is a TokenStreamHeader followed by blocks.  Each
+ * block is a TokenBlockHeader, that many fixed-size TokenRecords,
+ * and then the block's text: the lexemes of its records, back to
+ * back, which records point into by offset.  Errors reported while
+ * scanning are recorded in order as records of type TOKEN_ERROR whose
+ * text is the message, so a decoded stream reproduces pp1's combined
+ * stdout/stderr exactly.  Numbers are in the writer's native byte
+ * order.
+ */
+
+#ifndef _H_tokenstream
+#define _H_tokenstream
+
+#include <stdint.h>
+#include "scanner.h"
+
+#define TOKEN_STREAM_MAGIC      "PP1T"
+#define TOKEN_STREAM_VERSION    1
+
+#define TOKEN_ERROR             (-1)    // record type for an error message
+
+typedef struct {
+    char        magic[4];           // TOKEN_STREAM_MAGIC
+    uint32_t    version;            // TOKEN_STREAM_VERSION
+} TokenStreamHeader;
+
+typedef struct {
+    uint32_t    numRecords;         // records that follow
+    uint32_t    textBytes;          // text bytes after the records
+} TokenBlockHeader;
+
+typedef struct {
+    int32_t     type;               // TokenType, char, or TOKEN_ERROR
+    int32_t     line;               // yylloc.first_line
+    int32_t     firstColumn;        // yylloc.first_column
+    int32_t     lastColumn;         // yylloc.last_column
+    uint32_t    textOffset;         // lexeme's offset in the block text
+    uint32_t    textLength;         // lexeme's length
+    union {
+        int32_t integerConstant;    // T_IntConstant
+        int32_t boolConstant;       // T_BoolConstant
+        int32_t symbolId;           // T_Identifier: Declaration's id
+        int32_t hasPosition;        // TOKEN_ERROR: false if no position
+        double  doubleConstant;     // T_DoubleConstant
+    } value;
+} TokenRecord;
+
+
+/*
+ * Function: PrintOneToken()
+ * Usage: PrintOneToken(T_Double, "3.5", val, loc);
+ * -----------------------------------------------
+ * Prints one token in pp1's text format.
+ */
+void PrintOneToken(TokenType token, char *text, YYSTYPE value, yyltype loc);
+
+
+typedef struct TokenWriterImplementation *TokenWriter;
+
+/*
+ * Function: TokenWriterNew()
+ * Usage: writer = TokenWriterNew(STDOUT_FILENO, 0);
+ * -------------------------------------------------
+ * Makes a writer that sends a binary token stream to the given file
+ * descriptor.  Tokens are collected in one big buffer of bufferSize
+ * bytes (0 picks a default) and written out a whole block at a time.
+ */
+TokenWriter TokenWriterNew(int fd, int bufferSize);
+
+/*
+ * Function: TokenWriterAppend()
+ * Usage: TokenWriterAppend(writer, token, yytext, yyleng, yylval, yylloc);
+ * ------------------------------------------------------------------------
+ * Adds one token to the stream.
+ */
+void TokenWriterAppend(TokenWriter writer, TokenType token, const char *text,
+                       int length, YYSTYPE value, yyltype loc);
+
+/*
+ * Function: TokenWriterAppendError()
+ * ----------------------------------
+ * Adds an error message to the stream, at the position of the tokens
+ * appended so far.  pos may be NULL.  Intended for use as an
+ * ErrorHandlerFn with the writer as its client data.
+ */
+void TokenWriterAppendError(struct yyltype *pos, const char *message, void *writer);
+
+/*
+ * Function: TokenWriterFree()
+ * ---------------------------
+ * Writes out anything still buffered and frees the writer.
+ */
+void TokenWriterFree(TokenWriter writer);
+
+
+typedef struct TokenReaderImplementation *TokenReader;
+
+/*
+ * Function: TokenReaderNew()
+ * --------------------------
+ * Makes a reader for the binary token stream on the given file
+ * descriptor.  Fails if the stream doesn't start with a valid header.
+ */
+TokenReader TokenReaderNew(int fd);
+
+/*
+ * Function: TokenReaderNext()
+ * Usage: while (TokenReaderNext(reader, &record, &text)) ...
+ * ----------------------------------------------------------
+ * Reads the next record into record and points text at its lexeme,
+ * which is null-terminated and stays valid until the next call.
+ * Returns false at the end of the stream.
+ */
+bool TokenReaderNext(TokenReader reader, TokenRecord *record, char **text);
+
+/*
+ * Function: TokenReaderFree()
+ * ---------------------------
+ * Frees the reader.  The file descriptor is left open.
+ */
+void TokenReaderFree(TokenReader reader);
+
+#endif
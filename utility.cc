@@ -7,28 +7,47 @@
 #include "utility.h"
 #include <stdarg.h>
 #include <string.h>
+#include <errno.h>
+#include <unistd.h>
 
 
 #define BufferSize   2056
 
 
-void ReportError(struct yyltype *pos, char *format, ...)
+static thread_local ErrorHandlerFn gErrorHandler = NULL;
+static thread_local void *gErrorClientData = NULL;
+
+void SetErrorHandler(ErrorHandlerFn fn, void *clientData)
+{
+  gErrorHandler = fn;
+  gErrorClientData = clientData;
+}
+
+void PrintError(struct yyltype *pos, const char *message)
+{
+  fflush(stdout); // make sure any buffered text has been output
+  if (pos)
+      fprintf(stderr,"\n*** Error line %d column %d\n", pos->first_line, pos->first_column);
+  else
+      fprintf(stderr,"\n*** Error at unidentified position\n");
+  fprintf(stderr,"*** %s\n\n", message);
+}
+
+void ReportError(struct yyltype *pos, const char *format, ...)
 {
   va_list args;
   char errbuf[BufferSize];
+  int length;
   
   va_start(args, format);
-  vsprintf(errbuf,format, args);
+  length = vsnprintf(errbuf, sizeof errbuf, format, args);
   va_end(args);
-  if (strlen(errbuf) > BufferSize) {
+  if (length >= (int) sizeof errbuf) {
     Failure("Error message too long\n");
+  } else if (gErrorHandler) {
+    (*gErrorHandler)(pos, errbuf, gErrorClientData);
   } else {
-    fflush(stdout); // make sure any buffered text has been output
-    if (pos)
-	fprintf(stderr,"\n*** Error line %d column %d\n", pos->first_line, pos->first_column);
-    else
-	fprintf(stderr,"\n*** Error at unidentified position\n");
-   fprintf(stderr,"*** %s\n\n", errbuf);
+    PrintError(pos, errbuf);
   }
 }
 
@@ -43,12 +62,13 @@ void Failure(const char *format, ...)
 {
   va_list args;
   char errbuf[BufferSize];
+  int length;
   
   va_start(args, format);
-  vsprintf(errbuf, format, args);
+  length = vsnprintf(errbuf, sizeof errbuf, format, args);
   va_end(args);
   fflush(stdout);
-  if (strlen(errbuf) > BufferSize) 
+  if (length >= (int) sizeof errbuf) 
     fprintf(stderr, "\n*** Failure: Failure message too long\n\n");
   else 
     fprintf(stderr,"\n*** Failure: %s\n\n", errbuf);
@@ -57,45 +77,76 @@ void Failure(const char *format, ...)
 
 
 
-#define MaxDebugKeys 256
-
-static char *gDebugKeys[MaxDebugKeys];
+/*
+ * Debug keys are numbered in the order they are first used, and the
+ * number is the channel's bit in gDebugChannels.  Keys are only
+ * searched for when a channel is made, turned on, or used through
+ * PrintDebug() with its key.
+ */
+static const char *gDebugKeys[MaxDebugChannels];
 static int gNumDebugKeys = 0;
+uint64_t gDebugChannels[MaxDebugChannels / 64];
 
-static bool KeyInList(const char *key)
+static DebugChannel FindKey(const char *key)
 {
   int i;
   for (i = 0; i < gNumDebugKeys; i++) 
     if (strcmp(key, gDebugKeys[i]) == 0)
-      return true;
-  return false;
+      return i;
+  return -1;
+}
+
+DebugChannel DebugChannelNew(const char *key)
+{
+  DebugChannel channel = FindKey(key);
+
+  if (channel >= 0)
+    return channel;
+  if (gNumDebugKeys == MaxDebugChannels)
+    Failure("Too many debug keys, at most %d can be used", MaxDebugChannels);
+  gDebugKeys[gNumDebugKeys] = strdup(key);
+  return gNumDebugKeys++;
 }
 
 void DebugOn(const char *key)
 {
-  if (KeyInList(key))
-    return;
-  Assert(gNumDebugKeys < MaxDebugKeys - 1);
-  gDebugKeys[gNumDebugKeys++] = strdup(key);
+  DebugChannel channel = DebugChannelNew(key);
+
+  gDebugChannels[channel >> 6] |= (uint64_t)1 << (channel & 63);
 }
 
 
+/*
+ * The message goes straight to stdout with vprintf(), so there is no
+ * buffer to format it in first, and no limit on its length.
+ */
+static void PrintDebugMessage(DebugChannel channel, const char *format, va_list args)
+{
+  printf("+++ Debug(%s): ", gDebugKeys[channel]);
+  vprintf(format, args);
+  printf("\n");
+}
 
 void PrintDebug(const char *key, const char *format, ...)
 {
   va_list args;
-  char buf[BufferSize];
+  DebugChannel channel = FindKey(key);
 
-  if (!KeyInList(key)) 
+  if (channel < 0 || !DebugChannelOn(channel)) 
     return;
   
   va_start(args, format);
-  vsprintf(buf, format, args);
+  PrintDebugMessage(channel, format, args);
+  va_end(args);
+}
+
+void DebugPrintf(DebugChannel channel, const char *format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  PrintDebugMessage(channel, format, args);
   va_end(args);
-  if (strlen(buf) > BufferSize) 
-    Failure("PrintDebug message too long\n");
-  else
-    printf("+++ Debug(%s): %s\n", key, buf);
 }
 
 
@@ -108,15 +159,75 @@ char *CopyString(const char *s)
 	return copy;
 }
 
+char *CopyString(const char *s, int length)
+{
+	char	*copy = (char *) malloc(length + 1);
+	
+	memcpy(copy, s, length);
+	copy[length] = '\0';
+	return copy;
+}
 
-// StringHash adapted from Eric Roberts' _The Art and Science of C_
-int StringHash(const char *s, int numBuckets)
+char *CopyString(StringRef s)
+{
+	return CopyString(s.chars, s.length);
+}
+
+
+/*
+ * StringHashCode folds the string in one word at a time with a 64x64->128
+ * bit multiply whose halves are xored together, then finishes with the
+ * same fold keyed by the length.  The multiply spreads every input bit
+ * over the whole result.  Bytes past the end of the last partial word
+ * are never read.
+ */
+static const uint64_t HashPrime0 = 0xa0761d6478bd642fULL;
+static const uint64_t HashPrime1 = 0xe7037ed1a0b428dbULL;
+static const uint64_t HashPrime2 = 0x8ebc6af09c88c6e3ULL;
+
+static inline uint64_t HashMix(uint64_t a, uint64_t b)
 {
-	int				i;
-	unsigned long	hashcode = 0;
-	const long		MULTIPLIER = -1664117991;
+	__uint128_t		product = (__uint128_t)a * b;
 	
-	for (i = 0; i < strlen(s); i++)
-		hashcode = hashcode * MULTIPLIER + s[i];
-	return (hashcode % numBuckets);
-}
\ No newline at end of file
+	return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+HashCode StringHashCode(const char *s, int length)
+{
+	uint64_t		hashcode = HashPrime0;
+	uint64_t		word;
+	int				remaining = length;
+	
+	for (; remaining >= 8; s += 8, remaining -= 8) {
+		memcpy(&word, s, 8);
+		hashcode = HashMix(hashcode ^ word, HashPrime1);
+	}
+	if (remaining > 0) {
+		word = 0;
+		memcpy(&word, s, remaining);
+		hashcode = HashMix(hashcode ^ word, HashPrime1);
+	}
+	return HashMix(hashcode ^ HashPrime2, (uint64_t)length ^ HashPrime0);
+}
+
+int StringHash(const char *s, int numBuckets)
+{
+	return (StringHashCode(s, strlen(s)) % numBuckets);
+}
+
+bool WriteAll(int fd, const void *bytes, size_t size)
+{
+	const char	*p = (const char *) bytes;
+	ssize_t		n;
+
+	while (size > 0) {
+		n = write(fd, p, size);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+		p += n;
+		size -= n;
+	}
+	return true;
+}
@@ -10,6 +10,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include "scanner.h"
 
 
@@ -25,7 +26,31 @@
  * argument is the message to print, it accepts printf-style arguments
  * in the format string.
  */
-void ReportError(struct yyltype *pos, char *format, ...);
+void ReportError(struct yyltype *pos, const char *format, ...);
+
+
+/*
+ * Function: SetErrorHandler()
+ * Usage: SetErrorHandler(TokenWriterAppendError, writer);
+ * -------------------------------------------------------
+ * Sends the messages from ReportError() to fn instead of printing them.
+ * fn gets the position (possibly NULL), the formatted message, and the
+ * given clientData.  Pass NULL to go back to printing.  The handler
+ * is per thread, so threads scanning different files can each send
+ * their errors somewhere of their own.
+ */
+typedef void (*ErrorHandlerFn)(struct yyltype *pos, const char *message, void *clientData);
+
+void SetErrorHandler(ErrorHandlerFn fn, void *clientData);
+
+
+/*
+ * Function: PrintError()
+ * ----------------------
+ * Prints an already formatted error message the way ReportError()
+ * does when no handler is set.
+ */
+void PrintError(struct yyltype *pos, const char *message);
 
 
 /*
@@ -69,7 +94,9 @@ void Failure(const char *format, ...);
  * key.  For example, the usage line shown above will only print a message
  * if the call is preceded by a call to  DebugOn("parser").  The function
  * accepts printf arguments.  The provided main.cc parses the command line
- * to turn on debug flags.  See main.cc for more information.
+ * to turn on debug flags.  See main.cc for more information.  The key
+ * is looked up on every call, so code that runs often should use a
+ * DebugChannel and DebugPrint() instead.
  */
 void PrintDebug(const char *key, const char *format, ...);
 
@@ -83,8 +110,106 @@ void PrintDebug(const char *key, const char *format, ...);
  */
 void DebugOn(const char *key);
 
+
+/*
+ * Type: DebugChannel
+ * ------------------
+ * A debug key resolved once, up front, to a bit in gDebugChannels, so
+ * that checking it costs one test of that bit rather than a search
+ * for the key.  Keys and channels are two names for the same thing:
+ * DebugOn("lex") turns on the channel for "lex", whenever it was made.
+ * At most MaxDebugChannels keys can be used in all, as many as -d
+ * has always taken.
+ */
+#define MaxDebugChannels 256
+
+typedef int DebugChannel;
+
+// bit n % 64 of word n / 64 is on if channel n is
+extern uint64_t gDebugChannels[MaxDebugChannels / 64];
+
+/*
+ * Function: DebugChannelNew()
+ * Usage: static DebugChannel gLexDebug = DebugChannelNew("lex");
+ * --------------------------------------------------------------
+ * Returns the channel for key, making it if it is new.  Meant for
+ * static initializers, so that every channel is made before main()
+ * starts and any thread does its first check.
+ */
+DebugChannel DebugChannelNew(const char *key);
+
+/*
+ * Function: DebugChannelOn()
+ * --------------------------
+ * Returns true if messages on the channel are turned on.
+ */
+static inline bool DebugChannelOn(DebugChannel channel)
+{
+  return (gDebugChannels[channel >> 6] >> (channel & 63)) & 1;
+}
+
+/*
+ * Macro: DebugPrint()
+ * Usage: DebugPrint(gLexDebug, "found ident %s", ident);
+ * ------------------------------------------------------
+ * Like PrintDebug(), but for a channel.  When the channel is off this
+ * is one well-predicted branch: the arguments aren't even evaluated,
+ * let alone formatted, so it can go on paths that run for every token.
+ */
+#define DebugPrint(channel, ...)  \
+  (__builtin_expect(DebugChannelOn(channel), 0) ? DebugPrintf(channel, __VA_ARGS__) : (void)0)
+
+void DebugPrintf(DebugChannel channel, const char *format, ...);
+
 char *CopyString(const char *s);
 
+/*
+ * Function: CopyString()
+ * Usage: name = CopyString(yytext, yyleng);
+ * -----------------------------------------
+ * Returns a new null-terminated copy of the first length characters
+ * of s.  The source does not need to be null-terminated.
+ */
+char *CopyString(const char *s, int length);
+
+/*
+ * Function: CopyString()
+ * Usage: value = CopyString(yylval.stringConstant);
+ * -------------------------------------------------
+ * Returns a new null-terminated copy of the string a StringRef views.
+ */
+char *CopyString(StringRef s);
+
+/*
+ * Type: HashCode
+ * --------------
+ * A full 64-bit string hash, as returned by StringHashCode().
+ */
+typedef uint64_t HashCode;
+
+/*
+ * Function: StringHashCode()
+ * Usage: hash = StringHashCode(yytext, yyleng);
+ * ---------------------------------------------
+ * Returns the full 64-bit hash of the first length characters of s.
+ * It makes one pass over the string, eight bytes at a time, and every
+ * input bit affects every output bit, so any slice of the result
+ * (such as the low bits used for a power-of-two table) is usable.
+ * Compute it once per name and keep it: Declaration and SymbolTable
+ * cache it so that lookups and table growth never rehash a string.
+ * StringHash reduces it to a bucket number.
+ */
+HashCode StringHashCode(const char *s, int length);
+
 int StringHash(const char *s, int numBuckets);
 
+/*
+ * Function: WriteAll()
+ * Usage: if (!WriteAll(fd, &header, sizeof(header))) ...
+ * -------------------------------------------------------
+ * Writes all size bytes to fd, going on after short writes and
+ * interrupted ones.  Returns false, with errno set, if write() fails.
+ */
+bool WriteAll(int fd, const void *bytes, size_t size);
+
 #endif
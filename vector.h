@@ -0,0 +1,265 @@
+/*
+ * File: vector.h
+ * --------------
+ * Vector<T> is a growable array of T, the typed counterpart of the
+ * DArray in hash.h.  The element type is a template parameter, so
+ * elements are constructed in place and moved when the array grows or
+ * shifts, rather than copied as bytes, which is what a C++ class needs;
+ * and the comparisons given to Sort() and Search() are function objects
+ * that inline instead of being called through pointers.
+ *
+ * The capacity doubles whenever the array fills, so n appends cost O(n)
+ * element moves in all, and Reserve() or the range calls can make room
+ * for many elements at once.  Pointers and references to elements are
+ * good only until the next call that adds or removes elements.
+ *
+ * Vector<T, N> keeps its first N elements inside the object itself, so
+ * an array that never holds more than N allocates nothing.  The inline
+ * space is aligned for any type, as malloc()'s is, so that a Vector of
+ * chars can hold the bytes of other types.
+ */
+
+#ifndef _H_vector
+#define _H_vector
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include "utility.h"
+
+#ifndef NOT_FOUND
+#define NOT_FOUND -1    // returned when a search fails to find the key
+#endif
+
+template <typename T, int InlineCount = 0>
+class Vector
+{
+  private:
+    T *elems;                   // inlineElems or malloc'd storage
+    int count;                  // number of elements
+    int capacity;               // number of elements there is room for
+    alignas(T) alignas(max_align_t)
+        unsigned char inlineElems[InlineCount > 0 ? InlineCount * sizeof(T) : 1];
+
+    bool IsInline() const { return elems == (T *) inlineElems; }
+
+    /* Moves the elements to new storage with room for at least
+     * needed elements. */
+    void Grow(int needed)
+    {
+        int     newCapacity = (capacity < 4 ? 4 : capacity);
+        T       *newElems;
+        int     i;
+
+        while (newCapacity < needed)
+            newCapacity *= 2;
+        newElems = (T *) malloc(newCapacity * sizeof(T));
+        Assert(newElems != NULL);
+        for (i = 0; i < count; i++) {
+            new(&newElems[i]) T(std::move(elems[i]));
+            elems[i].~T();
+        }
+        if (!IsInline())
+            free(elems);
+        elems = newElems;
+        capacity = newCapacity;
+    }
+
+    /* Makes room for length elements at n, moving the ones from n on
+     * up.  The slots at [n, n + length) that were past the old end
+     * are left unconstructed and the rest hold moved-from elements;
+     * the count is not changed. */
+    void OpenGap(int n, int length)
+    {
+        int     i;
+
+        if (count + length > capacity)
+            Grow(count + length);
+        for (i = count - 1; i >= n; i--) {
+            if (i + length >= count)
+                new(&elems[i + length]) T(std::move(elems[i]));
+            else
+                elems[i + length] = std::move(elems[i]);
+        }
+    }
+
+    /* Stores elem in slot n of a gap made by OpenGap(). */
+    template <typename U>
+    void FillGap(int n, U &&elem)
+    {
+        if (n >= count)
+            new(&elems[n]) T(std::forward<U>(elem));
+        else
+            elems[n] = std::forward<U>(elem);
+    }
+
+  public:
+
+    /* Makes an empty array with room for sizeHint elements, or for
+     * InlineCount if that is more, before it needs to grow. */
+    Vector(int sizeHint = 0) : elems((T *) inlineElems), count(0), capacity(InlineCount)
+    {
+        assert(sizeHint >= 0);
+        if (sizeHint > capacity)
+            Grow(sizeHint);
+    }
+
+    /* Destroys every element and frees the storage. */
+    ~Vector()
+    {
+        Clear();
+        if (!IsInline())
+            free(elems);
+    }
+
+    Vector(const Vector &) = delete;
+    Vector &operator=(const Vector &) = delete;
+
+    /* Returns the number of elements. */
+    int Length() const { return count; }
+
+    /* Returns element n, which must exist. */
+    T &operator[](int n)
+    {
+        assert(0 <= n && n < count);
+        return elems[n];
+    }
+
+    const T &operator[](int n) const
+    {
+        assert(0 <= n && n < count);
+        return elems[n];
+    }
+
+    /* The elements, in order, for range loops and <algorithm>. */
+    T *begin() { return elems; }
+    T *end() { return elems + count; }
+
+    /* Makes sure there is room for n elements in all, so that
+     * appending up to that many moves nothing. */
+    void Reserve(int n)
+    {
+        if (n > capacity)
+            Grow(n);
+    }
+
+    /* Adds elem at the end.  It is taken by value, so appending an
+     * element of the array itself is safe. */
+    void Append(T elem)
+    {
+        if (count == capacity)
+            Grow(count + 1);
+        new(&elems[count]) T(std::move(elem));
+        count++;
+    }
+
+    /* Inserts elem at n, shifting the elements from n on up one.  n
+     * may be Length(), which appends. */
+    void InsertAt(T elem, int n)
+    {
+        assert(0 <= n && n <= count);
+        OpenGap(n, 1);
+        FillGap(n, std::move(elem));
+        count++;
+    }
+
+    /* Adds copies of the length elements at from at the end, making
+     * room for all of them at once.  from must not point into this
+     * array. */
+    void AppendRange(const T *from, int length)
+    {
+        InsertRange(from, length, count);
+    }
+
+    /* Inserts copies of the length elements at from at n, shifting
+     * the elements from n on up.  from must not point into this
+     * array. */
+    void InsertRange(const T *from, int length, int n)
+    {
+        int     i;
+
+        assert(0 <= n && n <= count && length >= 0);
+        assert(from + length <= elems || from >= elems + capacity);
+        OpenGap(n, length);
+        for (i = 0; i < length; i++)
+            FillGap(n + i, from[i]);
+        count += length;
+    }
+
+    /* Removes element n, shifting the ones after it down. */
+    void DeleteAt(int n)
+    {
+        DeleteRange(n, 1);
+    }
+
+    /* Removes the length elements from n on. */
+    void DeleteRange(int n, int length)
+    {
+        int     i;
+
+        assert(0 <= n && length >= 0 && n + length <= count);
+        std::move(elems + n + length, elems + count, elems + n);
+        for (i = count - length; i < count; i++)
+            elems[i].~T();
+        count -= length;
+    }
+
+    /* Replaces element n with elem. */
+    void ReplaceAt(T elem, int n)
+    {
+        assert(0 <= n && n < count);
+        elems[n] = std::move(elem);
+    }
+
+    /* Removes every element, keeping the storage. */
+    void Clear()
+    {
+        int     i;
+
+        for (i = 0; i < count; i++)
+            elems[i].~T();
+        count = 0;
+    }
+
+    /* Sorts the elements so that less(a, b) holds for no element a
+     * after an element b. */
+    template <typename Less>
+    void Sort(Less less)
+    {
+        std::sort(elems, elems + count, less);
+    }
+
+    /* Returns the index of the first element from fromIndex on for
+     * which matches(element) is true, or NOT_FOUND. */
+    template <typename Matches>
+    int Search(Matches matches, int fromIndex = 0)
+    {
+        int     i;
+
+        assert(0 <= fromIndex && fromIndex <= count);
+        for (i = fromIndex; i < count; i++)
+            if (matches(elems[i]))
+                return i;
+        return NOT_FOUND;
+    }
+
+    /* Same as above for an array sorted by less: returns the index
+     * of an element equal to key, or NOT_FOUND, by binary search.
+     * less must take an element and a key either way round. */
+    template <typename K, typename Less>
+    int SortedSearch(const K &key, Less less, int fromIndex = 0)
+    {
+        T       *found;
+
+        assert(0 <= fromIndex && fromIndex <= count);
+        found = std::lower_bound(elems + fromIndex, elems + count, key, less);
+        if (found == elems + count || less(key, *found))
+            return NOT_FOUND;
+        return found - elems;
+    }
+};
+
+#endif